@@ -0,0 +1,176 @@
+#include "EGP_ComponentCulling.h"
+
+#include "DataDrivenShaderPlatformInfo.h"
+#include "GlobalShader.h"
+#include "ShaderParameterStruct.h"
+#include "RenderGraphUtils.h"
+
+
+class FEGPCullComponentsCS : public FGlobalShader
+{
+public:
+	DECLARE_GLOBAL_SHADER(FEGPCullComponentsCS);
+	SHADER_USE_PARAMETER_STRUCT(FEGPCullComponentsCS, FGlobalShader);
+
+	static constexpr uint32 GroupSize = 64;
+
+	class FUseHZB : SHADER_PERMUTATION_BOOL("USE_HZB");
+	using FPermutationDomain = TShaderPermutationDomain<FUseHZB>;
+
+	BEGIN_SHADER_PARAMETER_STRUCT(FParameters, )
+		SHADER_PARAMETER_RDG_BUFFER_SRV(ByteAddressBuffer, SlotBounds)
+		SHADER_PARAMETER(uint32, NumSlots)
+		SHADER_PARAMETER(FMatrix44f, TranslatedWorldToClip)
+		SHADER_PARAMETER(FVector3f, PreViewTranslation)
+		SHADER_PARAMETER_RDG_TEXTURE(Texture2D, HZBTexture)
+		SHADER_PARAMETER_SAMPLER(SamplerState, HZBSampler)
+		SHADER_PARAMETER(FVector2f, HZBSize)
+		SHADER_PARAMETER(FVector2f, ViewportUVToHZBUV)
+		SHADER_PARAMETER(float, HZBMaxMip)
+		SHADER_PARAMETER_RDG_BUFFER_UAV(RWBuffer<uint>, RWVisibleSlots)
+		SHADER_PARAMETER_RDG_BUFFER_UAV(RWBuffer<uint>, RWVisibleCount)
+	END_SHADER_PARAMETER_STRUCT()
+
+	static bool ShouldCompilePermutation(const FGlobalShaderPermutationParameters& Parameters)
+	{
+		return IsFeatureLevelSupported(Parameters.Platform, ERHIFeatureLevel::SM5);
+	}
+	static void ModifyCompilationEnvironment(const FGlobalShaderPermutationParameters& Parameters, FShaderCompilerEnvironment& OutEnvironment)
+	{
+		FGlobalShader::ModifyCompilationEnvironment(Parameters, OutEnvironment);
+		OutEnvironment.SetDefine(TEXT("CULL_COMPONENTS"), 1);
+		OutEnvironment.SetDefine(TEXT("GROUP_SIZE"), GroupSize);
+	}
+};
+IMPLEMENT_GLOBAL_SHADER(FEGPCullComponentsCS, "/EGP/Culling/cull_components.usf", "CullCS", SF_Compute);
+
+class FEGPBuildCullingArgsCS : public FGlobalShader
+{
+public:
+	DECLARE_GLOBAL_SHADER(FEGPBuildCullingArgsCS);
+	SHADER_USE_PARAMETER_STRUCT(FEGPBuildCullingArgsCS, FGlobalShader);
+
+	BEGIN_SHADER_PARAMETER_STRUCT(FParameters, )
+		SHADER_PARAMETER_RDG_BUFFER_SRV(Buffer<uint>, VisibleCount)
+		SHADER_PARAMETER(uint32, IndexCountPerInstance)
+		SHADER_PARAMETER(uint32, StartIndexLocation)
+		SHADER_PARAMETER(int32, BaseVertexLocation)
+		SHADER_PARAMETER(uint32, DispatchGroupSize)
+		SHADER_PARAMETER_RDG_BUFFER_UAV(RWBuffer<uint>, RWDrawArgs)
+		SHADER_PARAMETER_RDG_BUFFER_UAV(RWBuffer<uint>, RWDispatchArgs)
+	END_SHADER_PARAMETER_STRUCT()
+
+	static bool ShouldCompilePermutation(const FGlobalShaderPermutationParameters& Parameters)
+	{
+		return IsFeatureLevelSupported(Parameters.Platform, ERHIFeatureLevel::SM5);
+	}
+	static void ModifyCompilationEnvironment(const FGlobalShaderPermutationParameters& Parameters, FShaderCompilerEnvironment& OutEnvironment)
+	{
+		FGlobalShader::ModifyCompilationEnvironment(Parameters, OutEnvironment);
+		OutEnvironment.SetDefine(TEXT("BUILD_ARGS"), 1);
+	}
+};
+IMPLEMENT_GLOBAL_SHADER(FEGPBuildCullingArgsCS, "/EGP/Culling/cull_components.usf", "BuildArgsCS", SF_Compute);
+
+
+EGP::FComponentCullingView EGP::FComponentCullingView::FromView(const FViewInfo& view, bool useViewHZB)
+{
+	FComponentCullingView output;
+	output.TranslatedWorldToClip = view.ViewMatrices.GetTranslatedViewProjectionMatrix();
+	output.PreViewTranslation = view.ViewMatrices.GetPreViewTranslation();
+
+	if (useViewHZB && view.HZB != nullptr)
+	{
+		output.HZB = view.HZB;
+		output.HZBMip0Size = view.HZBMipmap0Size;
+		//The HZB's first mip is half the view's resolution, rounded up to a power of two.
+		output.ViewportUVToHZBUV = {
+			static_cast<float>(view.ViewRect.Width()) / static_cast<float>(2 * view.HZBMipmap0Size.X),
+			static_cast<float>(view.ViewRect.Height()) / static_cast<float>(2 * view.HZBMipmap0Size.Y)
+		};
+	}
+
+	return output;
+}
+
+void EGP::FComponentCullingView::SetHZB(const FHiZPyramid& pyramid)
+{
+	checkf(pyramid.Mode == EHiZMode::Min, TEXT("Culling needs the furthest depth, which is the min device-Z"));
+	HZB = pyramid.Texture;
+	HZBMip0Size = pyramid.Mip0Size;
+	ViewportUVToHZBUV = pyramid.ViewportUVToHZBUV;
+}
+
+EGP::FComponentCullingResult EGP::AddComponentCullingPass(FRDGBuilder& graph, ERHIFeatureLevel::Type featureLevel,
+														  const CustomRenderPasses::FProxyGPUBuffer& components,
+														  const FComponentCullingView& view,
+														  const FComponentCullingDrawArgs& drawArgs,
+														  uint32 dispatchGroupSize, bool asyncCompute)
+{
+	checkf(components.Bounds != nullptr, TEXT("Component culling needs the pass's GPU proxy mirror ('MirrorProxiesToGPU')"));
+	check(dispatchGroupSize > 0);
+	RDG_EVENT_SCOPE(graph, "EGP::CullComponents(%i slots)", components.NumSlots);
+
+	const ERDGPassFlags flags = asyncCompute ? ERDGPassFlags::AsyncCompute : ERDGPassFlags::Compute;
+	auto* shaderMap = GetGlobalShaderMap(featureLevel);
+
+	FComponentCullingResult output;
+	output.VisibleSlots = graph.CreateBuffer(FRDGBufferDesc::CreateBufferDesc(sizeof(uint32), FMath::Max(components.NumSlots, 1u)),
+											 TEXT("EGP.CulledComponentSlots"));
+	output.VisibleCount = graph.CreateBuffer(FRDGBufferDesc::CreateBufferDesc(sizeof(uint32), 1),
+											 TEXT("EGP.CulledComponentCount"));
+	output.DrawArgs = graph.CreateBuffer(FRDGBufferDesc::CreateIndirectDesc<FRHIDrawIndexedIndirectParameters>(1),
+										 TEXT("EGP.CulledComponentDrawArgs"));
+	output.DispatchArgs = graph.CreateBuffer(FRDGBufferDesc::CreateIndirectDesc<FRHIDispatchIndirectParameters>(1),
+											 TEXT("EGP.CulledComponentDispatchArgs"));
+
+	auto countUAV = graph.CreateUAV(output.VisibleCount, PF_R32_UINT);
+	AddClearUAVPass(graph, flags, countUAV, 0u);
+
+	//Cull.
+	{
+		auto* params = graph.AllocParameters<FEGPCullComponentsCS::FParameters>();
+		params->SlotBounds = components.Bounds;
+		params->NumSlots = components.NumSlots;
+		params->TranslatedWorldToClip = FMatrix44f(view.TranslatedWorldToClip);
+		params->PreViewTranslation = FVector3f(view.PreViewTranslation);
+		params->RWVisibleSlots = graph.CreateUAV(output.VisibleSlots, PF_R32_UINT);
+		params->RWVisibleCount = countUAV;
+
+		const bool useHZB = (view.HZB != nullptr);
+		if (useHZB)
+		{
+			params->HZBTexture = view.HZB;
+			params->HZBSampler = TStaticSamplerState<SF_Point, AM_Clamp, AM_Clamp, AM_Clamp>::GetRHI();
+			params->HZBSize = FVector2f(view.HZBMip0Size);
+			params->ViewportUVToHZBUV = view.ViewportUVToHZBUV;
+			params->HZBMaxMip = static_cast<float>(view.HZB->Desc.NumMips - 1);
+		}
+
+		FEGPCullComponentsCS::FPermutationDomain permutation;
+		permutation.Set<FEGPCullComponentsCS::FUseHZB>(useHZB);
+		TShaderMapRef<FEGPCullComponentsCS> shader(shaderMap, permutation);
+
+		FComputeShaderUtils::AddPass(graph, RDG_EVENT_NAME("Cull%s", useHZB ? TEXT(" (HZB)") : TEXT("")),
+									 flags, shader, params,
+									 FComputeShaderUtils::GetGroupCount(static_cast<int32>(components.NumSlots),
+																		static_cast<int32>(FEGPCullComponentsCS::GroupSize)));
+	}
+
+	//Build indirect args.
+	{
+		auto* params = graph.AllocParameters<FEGPBuildCullingArgsCS::FParameters>();
+		params->VisibleCount = graph.CreateSRV(output.VisibleCount, PF_R32_UINT);
+		params->IndexCountPerInstance = drawArgs.IndexCountPerInstance;
+		params->StartIndexLocation = drawArgs.StartIndexLocation;
+		params->BaseVertexLocation = drawArgs.BaseVertexLocation;
+		params->DispatchGroupSize = dispatchGroupSize;
+		params->RWDrawArgs = graph.CreateUAV(output.DrawArgs, PF_R32_UINT);
+		params->RWDispatchArgs = graph.CreateUAV(output.DispatchArgs, PF_R32_UINT);
+
+		TShaderMapRef<FEGPBuildCullingArgsCS> shader(shaderMap);
+		FComputeShaderUtils::AddPass(graph, RDG_EVENT_NAME("BuildArgs"), flags, shader, params, FIntVector(1, 1, 1));
+	}
+
+	return output;
+}
@@ -3,6 +3,20 @@
 #include "Engine/TextureRenderTarget.h"
 #include "SceneViewExtensionContext.h"
 #include "Algo/AllOf.h"
+#include "UnifiedBuffer.h"
+#include "RenderGraphUtils.h"
+#include "ProfilingDebugging/CsvProfiler.h"
+
+
+DECLARE_CYCLE_STAT(TEXT("Collect Pass Proxies"), STAT_EGP_CollectProxies, STATGROUP_EGP);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Pass Components"), STAT_EGP_Components, STATGROUP_EGP);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Proxy Updates Sent"), STAT_EGP_ProxyUpdates, STATGROUP_EGP);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Proxy Update Bytes"), STAT_EGP_ProxyBytes, STATGROUP_EGP);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Oversized Parallel Proxies"), STAT_EGP_OversizedProxies, STATGROUP_EGP);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Render Commands Enqueued"), STAT_EGP_RenderCommands, STATGROUP_EGP);
+DECLARE_DWORD_COUNTER_STAT(TEXT("View Filter Rejects"), STAT_EGP_ViewFilterRejects, STATGROUP_EGP);
+
+CSV_DEFINE_CATEGORY(EGP, true);
 
 
 bool U_EGP_ViewFilter::ShouldRenderFor(const FViewport* viewport) const
@@ -12,7 +26,7 @@ bool U_EGP_ViewFilter::ShouldRenderFor(const FViewport* viewport) const
 	check(rThread || gThread);
 	
 	return !ExcludeAll &&
-		     ((rThread && byViewport_RT.IsAllowed(viewport)) ||
+		     ((rThread && snapshot_RT->byViewport.IsAllowed(viewport)) ||
 		      (gThread && byViewport_GT.IsAllowed(viewport)));
 }
 bool U_EGP_ViewFilter::ShouldRenderFor(const FSceneInterface* scene) const
@@ -22,7 +36,7 @@ bool U_EGP_ViewFilter::ShouldRenderFor(const FSceneInterface* scene) const
 	check(rThread || gThread);
 	
 	return !ExcludeAll &&
-		     ((rThread && byScene_RT.IsAllowed(scene)) ||
+		     ((rThread && snapshot_RT->byScene.IsAllowed(scene)) ||
 		      (gThread && byScene_GT.IsAllowed(scene)));
 }
 bool U_EGP_ViewFilter::ShouldRenderFor(const FSceneViewExtensionContext& sveContext) const
@@ -35,12 +49,32 @@ bool U_EGP_ViewFilter::ShouldRenderFor(const FSceneViewFamily& viewFamily) const
 	bool rThread = IsInRenderingThread(),
 		 gThread = IsInGameThread();
 	check(rThread || gThread);
-	
-	return !ExcludeAll &&
-		     ((rThread && byScene_RT.IsAllowed(viewFamily.Scene)) ||
-		      (gThread && byScene_GT.IsAllowed(viewFamily.Scene))) &&
-		     ((rThread && byRenderTarget_RT.IsAllowed(viewFamily.RenderTarget)) ||
-		      (gThread && byRenderTarget_GT.IsAllowed(viewFamily.RenderTarget)));
+
+	if (ExcludeAll)
+		return false;
+
+	//Each thread only reads its own copy of the filters, so each thread gets its own cache.
+	//If running without a render thread then both copies are used, and the sum of their versions is still unique.
+	auto& cache = rThread ? familyVerdicts_RT : familyVerdicts_GT;
+	uint32 filterVersion = (rThread ? (snapshot_RT->byScene.GetVersion() + snapshot_RT->byRenderTarget.GetVersion()) : 0) +
+						   (gThread ? (byScene_GT.GetVersion() + byRenderTarget_GT.GetVersion()) : 0);
+	if (cache.FrameNumber != viewFamily.FrameNumber || cache.FilterVersion != filterVersion)
+	{
+		cache.Verdicts.Reset();
+		cache.FrameNumber = viewFamily.FrameNumber;
+		cache.FilterVersion = filterVersion;
+	}
+
+	const TPair<const FSceneInterface*, const FRenderTarget*> key{ viewFamily.Scene, viewFamily.RenderTarget };
+	if (const bool* cached = cache.Verdicts.Find(key))
+		return *cached;
+
+	bool verdict = ((rThread && snapshot_RT->byScene.IsAllowed(viewFamily.Scene)) ||
+		            (gThread && byScene_GT.IsAllowed(viewFamily.Scene))) &&
+		           ((rThread && snapshot_RT->byRenderTarget.IsAllowed(viewFamily.RenderTarget)) ||
+		            (gThread && byRenderTarget_GT.IsAllowed(viewFamily.RenderTarget)));
+	cache.Verdicts.Add(key, verdict);
+	return verdict;
 }
 bool U_EGP_ViewFilter::ShouldRenderFor(const FSceneView& view) const
 {
@@ -49,12 +83,29 @@ bool U_EGP_ViewFilter::ShouldRenderFor(const FSceneView& view) const
 	check(rThread || gThread);
 	
 	return ShouldRenderFor(*view.Family) &&
-		   ((rThread && byPlayerIndex_RT.IsAllowed(view.PlayerIndex)) ||
+		   ((rThread && snapshot_RT->byPlayerIndex.IsAllowed(view.PlayerIndex)) ||
 		   	(gThread && byPlayerIndex_GT.IsAllowed(view.PlayerIndex))) &&
-		   ((rThread && byViewActor_RT.IsAllowed(view.ViewActor)) ||
+		   ((rThread && snapshot_RT->byViewActor.IsAllowed(view.ViewActor)) ||
 		   	(gThread && byViewActor_GT.IsAllowed(view.ViewActor)));
 }
 
+void U_EGP_ViewFilter::SyncToRenderThread()
+{
+	check(IsInGameThread());
+	if (!isDirty_GT)
+		return;
+	isDirty_GT = false;
+
+	TSharedRef<const FSnapshot, ESPMode::ThreadSafe> snapshot = MakeShared<const FSnapshot, ESPMode::ThreadSafe>(FSnapshot{
+		byRenderTarget_GT, byScene_GT, byViewport_GT, byViewActor_GT, byPlayerIndex_GT
+	});
+	auto* _this = this;
+	ENQUEUE_RENDER_COMMAND(SyncViewFilter)([_this, snapshot](FRHICommandListImmediate&)
+	{
+		_this->snapshot_RT = snapshot;
+	});
+}
+
 void U_EGP_ViewFilter::FilterByRenderTarget(UTextureRenderTarget* rt, bool isWhitelist)
 {
 	check(IsInGameThread());
@@ -62,7 +113,7 @@ void U_EGP_ViewFilter::FilterByRenderTarget(UTextureRenderTarget* rt, bool isWhi
 	if (rt == nullptr)
 	{
 		const FRenderTarget* nullRT = nullptr;
-		UpdateFilterList(byRenderTarget_GT, byRenderTarget_RT, nullRT, true, isWhitelist);
+		UpdateFilterList(byRenderTarget_GT, nullRT, true, isWhitelist);
 	}
 	else
 	{
@@ -79,7 +130,7 @@ void U_EGP_ViewFilter::RemoveByRenderTarget(UTextureRenderTarget* rt)
 	if (rt == nullptr)
 	{
 		const FRenderTarget* nullRT = nullptr;
-		UpdateFilterList(byRenderTarget_GT, byRenderTarget_RT, nullRT, true, false);
+		UpdateFilterList(byRenderTarget_GT, nullRT, true, false);
 	}
 	else
 	{
@@ -91,10 +142,83 @@ void U_EGP_ViewFilter::RemoveByRenderTarget(UTextureRenderTarget* rt)
 }
 
 
+void EGP::CustomRenderPasses::FProxyStorage::Add(int32 slot, const U_EGP_RenderPassComponent* component,
+												 int32 nProxyBytes)
+{
+	check(IsInRenderingThread());
+
+	//The stride is normally set once, by the first component to register.
+	if (nProxyBytes > proxyStride)
+		SetStride(Align(nProxyBytes, ProxyAlignment));
+
+	while (slotToDense.Num() <= slot)
+		slotToDense.Add(INDEX_NONE);
+	check(slotToDense[slot] == INDEX_NONE);
+
+	slotToDense[slot] = elements.Num();
+	denseToSlot.Add(slot);
+	elements.Add({ component, nullptr, false });
+	proxyBytes.AddZeroed(proxyStride);
+}
+void EGP::CustomRenderPasses::FProxyStorage::Remove(int32 slot)
+{
+	check(IsInRenderingThread());
+
+	int32 denseIdx = GetDenseIndex(slot);
+	check(denseIdx != INDEX_NONE);
+
+	//Move the last element into the hole.
+	int32 lastDenseIdx = elements.Num() - 1;
+	if (denseIdx != lastDenseIdx)
+	{
+		int32 lastSlot = denseToSlot[lastDenseIdx];
+		elements[denseIdx] = elements[lastDenseIdx];
+		denseToSlot[denseIdx] = lastSlot;
+		slotToDense[lastSlot] = denseIdx;
+		if (proxyStride > 0)
+			FMemory::Memcpy(GetProxy(denseIdx), GetProxy(lastDenseIdx), proxyStride);
+	}
+
+	elements.RemoveAt(lastDenseIdx, 1, false);
+	denseToSlot.RemoveAt(lastDenseIdx, 1, false);
+	proxyBytes.SetNum(elements.Num() * proxyStride, false);
+	slotToDense[slot] = INDEX_NONE;
+}
+void EGP::CustomRenderPasses::FProxyStorage::Write(int32 slot, const TWeakObjectPtr<UPrimitiveComponent>& target,
+												   const std::byte* proxy, int32 nProxyBytes)
+{
+	check(IsInRenderingThread());
+
+	int32 denseIdx = GetDenseIndex(slot);
+	check(denseIdx != INDEX_NONE);
+
+	checkf(nProxyBytes <= proxyStride,
+		   TEXT("Proxy is bigger (%i) than the size its component reported at registration (%i)"),
+		   nProxyBytes, proxyStride);
+
+	auto& element = elements[denseIdx];
+	element.Target = target;
+	element.HasProxy = true;
+	FMemory::Memcpy(GetProxy(denseIdx), proxy, nProxyBytes);
+}
+void EGP::CustomRenderPasses::FProxyStorage::SetStride(int32 newStride)
+{
+	//Re-pack the proxies with the new stride.
+	TArray<std::byte> newBytes;
+	newBytes.AddZeroed(elements.Num() * newStride);
+	if (proxyStride > 0)
+		for (int32 i = 0; i < elements.Num(); ++i)
+			FMemory::Memcpy(newBytes.GetData() + (i * newStride), GetProxy(i), proxyStride);
+
+	proxyBytes = MoveTemp(newBytes);
+	proxyStride = newStride;
+}
+
+
 U_EGP_RenderPassComponent::U_EGP_RenderPassComponent()
-	: renderThreadProxy(MakeShared<EGP::CustomRenderPasses::ProxyData_t>())
 {
-	PrimaryComponentTick.bCanEverTick = true;
+	//The owning pass gathers proxies itself, so components don't need to tick.
+	PrimaryComponentTick.bCanEverTick = false;
 }
 void U_EGP_RenderPassComponent::BeginPlay()
 {
@@ -115,31 +239,123 @@ void U_EGP_RenderPassComponent::EndPlay(const EEndPlayReason::Type reason)
 	auto* world = GetWorld();
 	auto* subsystem = (IsValid(world)) ? world->GetSubsystem<U_EGP_RenderPassSubsystem>() : nullptr;
 	auto* pass = IsValid(subsystem) ? subsystem->GetPass(GetPassType(), true) : nullptr;
+
+	//The proxy lives in the pass's storage, so destroy it before unregistering.
+	DestructProxyData_GameThread();
+
 	if (IsValid(pass))
 		pass->UnregisterPassComponent(this);
 	
-	DestructProxyData_GameThread();
-	
 	Super::EndPlay(reason);
 }
-void U_EGP_RenderPassComponent::TickComponent(float deltaSeconds, ELevelTick, FActorComponentTickFunction*)
+void U_EGP_RenderPassComponent::BeginDestroy()
+{
+	Super::BeginDestroy();
+
+	//The render thread may still be holding onto this component from a previous frame.
+	renderThreadFence.BeginFence();
+}
+bool U_EGP_RenderPassComponent::IsReadyForFinishDestroy()
+{
+	return Super::IsReadyForFinishDestroy() && renderThreadFence.IsFenceComplete();
+}
+const std::byte* U_EGP_RenderPassComponent::GetProxy_RenderThread() const
+{
+	return GetMutableProxy_RenderThread();
+}
+std::byte* U_EGP_RenderPassComponent::GetMutableProxy_RenderThread() const
+{
+	check(IsInRenderingThread());
+	if (renderThreadPass == nullptr)
+		return nullptr;
+
+	auto& storage = renderThreadPass->ComponentProxies_RenderThread;
+	int32 denseIdx = storage.GetDenseIndex(renderThreadSlot);
+	return (denseIdx == INDEX_NONE || !storage.GetElement(denseIdx).HasProxy) ?
+			   nullptr :
+			   storage.GetProxy(denseIdx);
+}
+UPrimitiveComponent* U_EGP_RenderPassComponent::GetTarget_RenderThread() const
+{
+	check(IsInRenderingThread());
+	if (renderThreadPass == nullptr)
+		return nullptr;
+
+	const auto& storage = renderThreadPass->ComponentProxies_RenderThread;
+	int32 denseIdx = storage.GetDenseIndex(renderThreadSlot);
+	return (denseIdx == INDEX_NONE) ? nullptr : storage.GetElement(denseIdx).Target.Get();
+}
+bool U_EGP_RenderPassComponent::WriteProxyUpdate_GameThread(EGP::CustomRenderPasses::FProxyUpdateBatch& batch)
 {
-	//Update the render-thread references.
-	//TODO: Double-check that this actually works as intended (change proxy data during play and see that it updates).
+	//Construct the proxy directly in the batch's memory.
+	int32 previousBatchSize = batch.Bytes.Num();
+	int32 proxyOffset = batch.Allocate(GetProxyByteSize());
+
+	EGP::CustomRenderPasses::FProxyUpdateBatch::FEntry entry;
+	if (!BuildProxyUpdate(batch.Bytes.GetData() + proxyOffset, entry))
 	{
-		TRACE_CPUPROFILER_EVENT_SCOPE_TEXT(*FString::Printf(TEXT("EGP.UpdateCustomRenderProxy %s"), *GetName()));
-		EGP::CustomRenderPasses::ProxyData_t newProxy;
-		ConstructProxyData_GameThread(newProxy);
-		
-		auto renderThreadSharedPtr = renderThreadProxy;
-		auto* targetPtr = &renderThreadTarget;
-		auto* newTarget = Cast<UPrimitiveComponent>(GetAttachParent());
-		ENQUEUE_RENDER_COMMAND(CopyCustomPassProxy)([renderThreadSharedPtr, targetPtr, newProxy, newTarget](FRHICommandListImmediate&)
-		{
-			*renderThreadSharedPtr = newProxy;
-			*targetPtr = newTarget;
-		});
+		//Nothing changed, so give the memory back to the batch.
+		batch.Bytes.SetNum(previousBatchSize, false);
+		return false;
+	}
+
+	entry.ByteOffset = proxyOffset;
+	batch.Entries.Add(entry);
+	return true;
+}
+bool U_EGP_RenderPassComponent::BuildProxyUpdate(std::byte* output, EGP::CustomRenderPasses::FProxyUpdateBatch::FEntry& outEntry)
+{
+	auto* newTarget = Cast<UPrimitiveComponent>(GetAttachParent());
+	bool needsUpdate = isProxyDirty ||
+					   (newTarget != lastSentTarget) ||
+					   (ProxyUpdateMode == E_EGP_ProxyUpdateMode::EveryFrame);
+
+	//Static components don't even need their proxy built.
+	if (!needsUpdate && ProxyUpdateMode == E_EGP_ProxyUpdateMode::OnlyWhenDirty)
+		return false;
+
+	//In 'CompareBytes' mode we have to build the proxy to know whether it changed.
+	int32 proxySize = GetProxyByteSize();
+	ConstructProxyData_GameThread(output);
+	if (!needsUpdate && ProxyUpdateMode == E_EGP_ProxyUpdateMode::CompareBytes)
+		needsUpdate = (proxySize != lastSentProxy.Num()) ||
+					  (FMemory::Memcmp(output, lastSentProxy.GetData(), proxySize) != 0);
+	isProxyDirty = false;
+
+	if (!needsUpdate)
+		return false;
+
+	if (ProxyUpdateMode == E_EGP_ProxyUpdateMode::CompareBytes)
+	{
+		lastSentProxy.SetNumUninitialized(proxySize, false);
+		FMemory::Memcpy(lastSentProxy.GetData(), output, proxySize);
 	}
+	lastSentTarget = newTarget;
+
+	outEntry.Slot = gameThreadSlot;
+	outEntry.Target = newTarget;
+	outEntry.ByteCount = proxySize;
+	return true;
+}
+void U_EGP_RenderPassComponent::OnAttachmentChanged()
+{
+	Super::OnAttachmentChanged();
+
+	//The target is the attach-parent, so it needs to be re-sent.
+	MarkProxyDirty();
+}
+void U_EGP_RenderPassComponent::SetProxyUpdateMode(E_EGP_ProxyUpdateMode newMode)
+{
+	ProxyUpdateMode = newMode;
+	if (newMode != E_EGP_ProxyUpdateMode::CompareBytes)
+		lastSentProxy.Empty();
+
+	//Make sure the proxy is sent at least once in the new mode.
+	MarkProxyDirty();
+}
+void U_EGP_RenderPassComponent::MarkProxyDirty()
+{
+	isProxyDirty = true;
 }
 
 U_EGP_RenderPass::U_EGP_RenderPass()
@@ -147,64 +363,452 @@ U_EGP_RenderPass::U_EGP_RenderPass()
 {
 	
 }
-inline void U_EGP_RenderPass::Tick_GameThread(UWorld& thisWorld, float deltaSeconds)
+void U_EGP_RenderPass::Tick_GameThread(UWorld& thisWorld, float deltaSeconds)
 {
-	//Collect the components to use in the pass this frame and send it to the render thread.
-	//Try to avoid heap usage, but also avoid coming up with a complex memory-pooling solution for this array,
-	//    by assuming there are at most N components.
-	constexpr uint32 StackCount = 256;
-	TArray<U_EGP_RenderPassComponent*, TInlineAllocator<StackCount>> components;
-	for (const auto& c : Components_GameThread)
-		if (IsValid(c))
-			components.Add(c);
-	if (!warnedAboutArrayHeapUsage && components.Num() > StackCount)
+	//Grab a recycled batch if one has come back from the render thread.
+	TUniquePtr<EGP::CustomRenderPasses::FProxyUpdateBatch> batch;
+	if (!recycledBatches.Dequeue(batch))
+		batch = MakeUnique<EGP::CustomRenderPasses::FProxyUpdateBatch>();
+
+	//Collect every proxy that changed this frame into it.
+	int32 nOversizedProxies = 0;
 	{
-		UE_LOG(LogEGP, Warning,
-			   TEXT("Custom render pass '%s' can only hold %i components "
-					  "before some heap usage happens every frame. We are now at %i components!"),
-			   *GetName(), StackCount, components.Num());
-		warnedAboutArrayHeapUsage = true;
+		TRACE_CPUPROFILER_EVENT_SCOPE(EGP_CollectCustomPassProxies);
+		SCOPE_CYCLE_COUNTER(STAT_EGP_CollectProxies);
+
+		const uint64 startCycles = FPlatformTime::Cycles64();
+
+		//Components that can't be built in parallel are handled immediately.
+		check(parallelComponentsBuffer.IsEmpty());
+		auto collectComponent = [&](U_EGP_RenderPassComponent* c)
+		{
+			if (!IsValid(c))
+				return;
+
+			if (ParallelProxyConstruction && c->IsProxyConstructionThreadSafe())
+				parallelComponentsBuffer.Add(c);
+			else
+				c->WriteProxyUpdate_GameThread(*batch);
+		};
+		int32 nVisitedComponents = 0;
+		if (TimeSliceProxyUpdates)
+		{
+			nVisitedComponents = ForEachTimeSlicedComponent_GameThread(collectComponent);
+		}
+		else
+		{
+			for (auto* c : Components_GameThread)
+				collectComponent(c);
+			//Nothing waits for a slice, in case time-slicing was turned off with components still queued.
+			timeSliceNewComponents_GameThread.Reset();
+		}
+
+		//The rest get pre-sized space in the batch, one entry and one proxy-sized block each,
+		//    so that workers never touch the same memory.
+		if (parallelComponentsBuffer.Num() > 0)
+		{
+			TRACE_CPUPROFILER_EVENT_SCOPE(EGP_CollectCustomPassProxiesParallel);
+
+			const int32 nParallel = parallelComponentsBuffer.Num();
+			const int32 firstEntryIdx = batch->Entries.Num();
+			const int32 stride = Align(FMath::Max(1, proxyByteSize_GameThread),
+									   EGP::CustomRenderPasses::ProxyAlignment);
+			const int32 firstByteIdx = batch->Allocate(stride * nParallel);
+			batch->Entries.AddDefaulted(nParallel);
+
+			auto* batchPtr = batch.Get();
+			ParallelFor(TEXT("EGP.CollectCustomPassProxies"), nParallel, 64, [&](int32 i)
+			{
+				auto* c = parallelComponentsBuffer[i];
+				auto& entry = batchPtr->Entries[firstEntryIdx + i];
+				const int32 byteOffset = firstByteIdx + (i * stride);
+
+				//Mark entries that don't need to be sent, so they can be dropped below.
+				if (c->GetProxyByteSize() <= stride &&
+					c->BuildProxyUpdate(batchPtr->Bytes.GetData() + byteOffset, entry))
+				{
+					entry.ByteOffset = byteOffset;
+				}
+				else
+				{
+					entry.Slot = INDEX_NONE;
+				}
+			});
+
+			//Components with the wrong proxy size don't fit the pre-sized blocks; build them normally.
+			for (auto* c : parallelComponentsBuffer)
+			{
+				if (c->GetProxyByteSize() > stride)
+				{
+					c->WriteProxyUpdate_GameThread(*batch);
+					nOversizedProxies += 1;
+				}
+			}
+
+			batch->Entries.RemoveAll([](const auto& e) { return e.Slot == INDEX_NONE; });
+			parallelComponentsBuffer.Reset();
+		}
+
+		//Refine the time-slicing estimate, smoothed so that one hitch doesn't starve the next slices.
+		if (TimeSliceProxyUpdates && nVisitedComponents > 0)
+		{
+			const double cyclesPerComponent = static_cast<double>(FPlatformTime::Cycles64() - startCycles) / nVisitedComponents;
+			timeSliceCyclesPerComponent_GameThread = (timeSliceCyclesPerComponent_GameThread <= 0) ?
+														 cyclesPerComponent :
+														 FMath::Lerp(timeSliceCyclesPerComponent_GameThread, cyclesPerComponent, 0.25);
+		}
 	}
 
-	//Submit the proxy data and schedule a render-thread tick.
+	nRenderCommands_GameThread += 1;
+	ReportStats_GameThread(batch.Get(), nOversizedProxies);
+
+	//Submit the proxy changes and schedule a render-thread tick, all in one command.
 	auto* _this = this;
 	const auto* scene = thisWorld.Scene;
-	ENQUEUE_RENDER_COMMAND(UpdateCustomRenderPassProxies)([_this, scene, deltaSeconds, components = MoveTemp(components)](FRHICommandListImmediate&)
+	bool mirrorToGPU = MirrorProxiesToGPU;
+	ENQUEUE_RENDER_COMMAND(UpdateCustomRenderPassProxies)([_this, scene, deltaSeconds, mirrorToGPU, batch = MoveTemp(batch)](FRHICommandListImmediate&) mutable
 	{
-		_this->ComponentProxies_RenderThread.Reset();
-		for (const auto& c : components)
+		//When the GPU mirror is switched on, every existing proxy needs to be uploaded.
+		if (mirrorToGPU && !_this->mirrorProxiesToGPU_RenderThread)
 		{
-			const auto& proxy = c->GetProxy_RenderThread();
-			if (!_this->warnedAboutProxyHeapUsage && proxy.Num() > EGP::CustomRenderPasses::MaxInlineProxyByteSize)
-			{
-				UE_LOG(LogEGP, Warning,
-					   TEXT("Render-thread proxy for custom render pass '%s' exceeds %i bytes (%i), "
-							   "meaning it is allocated on the heap instead of the stack, "
-							   "several times per frame per component! "
-							   "Consider replacing the struct with a pooled memory pointer to avoid a performance hit."),
-					   *_this->GetName(), EGP::CustomRenderPasses::MaxInlineProxyByteSize, proxy.Num());
-				_this->warnedAboutProxyHeapUsage = true;
-			}
-			
-			_this->ComponentProxies_RenderThread.Add(c, proxy);
+			const auto& storage = _this->ComponentProxies_RenderThread;
+			for (int32 i = 0; i < storage.Num(); ++i)
+				_this->gpuDirtySlots_RenderThread.Add(storage.GetSlot(i));
 		}
+		else if (!mirrorToGPU && _this->mirrorProxiesToGPU_RenderThread)
+		{
+			_this->gpuProxies_RenderThread.SafeRelease();
+			_this->gpuDirtySlots_RenderThread.Empty();
+			_this->gpuPrimitiveSlots_RenderThread.SafeRelease();
+			_this->gpuSlotBounds_RenderThread.SafeRelease();
+			_this->gpuSlotPrimitives_RenderThread.Empty();
+		}
+		_this->mirrorProxiesToGPU_RenderThread = mirrorToGPU;
+
+		_this->ApplyProxyUpdates_RenderThread(*batch);
+
+		//Send the batch's memory back to the game thread for next frame.
+		batch->Reset();
+		_this->recycledBatches.Enqueue(MoveTemp(batch));
 
 		_this->Tick_RenderThread(*scene, deltaSeconds);
 	});
 }
-inline void U_EGP_RenderPass::Tick_RenderThread(const FSceneInterface& thisScene, float gameThreadDeltaSeconds)
+int32 U_EGP_RenderPass::ForEachTimeSlicedComponent_GameThread(TFunctionRef<void(U_EGP_RenderPassComponent*)> toDo)
+{
+	//Components that just registered have nothing on the render thread yet, so they don't wait their turn.
+	//They're also in the rotation, so remember them to avoid visiting them twice.
+	const int32 nNew = timeSliceNewComponents_GameThread.Num();
+	timeSliceVisitedNew_GameThread.Reset();
+	for (auto* c : timeSliceNewComponents_GameThread)
+	{
+		toDo(c);
+		timeSliceVisitedNew_GameThread.Add(c);
+	}
+	timeSliceNewComponents_GameThread.Reset();
+
+	if (timeSliceOrderIsDirty_GameThread)
+	{
+		timeSliceOrder_GameThread = Components_GameThread.Array();
+		timeSliceOrderIsDirty_GameThread = false;
+	}
+	const int32 nComponents = timeSliceOrder_GameThread.Num();
+	if (nComponents == 0)
+		return nNew;
+
+	//Size the slice from the measured cost of previous slices.
+	//Before there's a measurement, start small.
+	constexpr int32 InitialSliceSize = 64;
+	int32 sliceSize = InitialSliceSize;
+	if (timeSliceCyclesPerComponent_GameThread > 0)
+	{
+		const double budgetCycles = (ProxyUpdateBudgetMicroseconds / 1000000.0) / FPlatformTime::GetSecondsPerCycle64();
+		sliceSize = FMath::FloorToInt32(FMath::Min(budgetCycles / timeSliceCyclesPerComponent_GameThread,
+												   static_cast<double>(nComponents)));
+	}
+	//Always make some progress.
+	sliceSize = FMath::Max(sliceSize - nNew, 1);
+
+	//Walk the rotation at most once, so that no component is refreshed twice in one tick.
+	int32 nSliced = 0;
+	timeSliceCursor_GameThread %= nComponents;
+	for (int32 i = 0; i < nComponents && nSliced < sliceSize; ++i)
+	{
+		auto* c = timeSliceOrder_GameThread[timeSliceCursor_GameThread];
+		timeSliceCursor_GameThread = (timeSliceCursor_GameThread + 1) % nComponents;
+
+		if (nNew > 0 && timeSliceVisitedNew_GameThread.Contains(c))
+			continue;
+		toDo(c);
+		nSliced += 1;
+	}
+
+	return nNew + nSliced;
+}
+void U_EGP_RenderPass::ReportStats_GameThread(const EGP::CustomRenderPasses::FProxyUpdateBatch* batch,
+											  int32 nOversizedProxies)
+{
+	//Only count the proxies that are actually sent;
+	//    the batch's byte buffer also holds the pre-sized blocks of dropped parallel entries.
+	int32 nProxyBytes = 0;
+	if (batch != nullptr)
+		for (const auto& entry : batch->Entries)
+			nProxyBytes += entry.ByteCount;
+
+	const int32 nComponents = Components_GameThread.Num(),
+				nProxyUpdates = (batch == nullptr) ? 0 : batch->Entries.Num(),
+				nRenderCommands = nRenderCommands_GameThread,
+				nRejects = nViewFilterRejects.exchange(0, std::memory_order_relaxed);
+	nRenderCommands_GameThread = 0;
+
+	INC_DWORD_STAT_BY(STAT_EGP_Components, nComponents);
+	INC_DWORD_STAT_BY(STAT_EGP_ProxyUpdates, nProxyUpdates);
+	INC_DWORD_STAT_BY(STAT_EGP_ProxyBytes, nProxyBytes);
+	INC_DWORD_STAT_BY(STAT_EGP_OversizedProxies, nOversizedProxies);
+	INC_DWORD_STAT_BY(STAT_EGP_RenderCommands, nRenderCommands);
+	INC_DWORD_STAT_BY(STAT_EGP_ViewFilterRejects, nRejects);
+
+#if CSV_PROFILER
+	if (!csvStatNames.IsSet())
+	{
+		const FString passName = GetClass()->GetName();
+		auto makeName = [&](const TCHAR* stat) { return FName(*FString::Printf(TEXT("%s_%s"), *passName, stat)); };
+		csvStatNames = FCsvStatNames{
+			makeName(TEXT("Components")), makeName(TEXT("ProxyUpdates")), makeName(TEXT("ProxyBytes")),
+			makeName(TEXT("OversizedProxies")), makeName(TEXT("RenderCommands")), makeName(TEXT("ViewFilterRejects"))
+		};
+	}
+
+	//Accumulate, so that passes of the same type in different worlds (e.g. PIE clients) add up.
+	const auto& names = csvStatNames.GetValue();
+	const int32 category = CSV_CATEGORY_INDEX(EGP);
+	FCsvProfiler::RecordCustomStat(names.Components, category, nComponents, ECsvCustomStatOp::Accumulate);
+	FCsvProfiler::RecordCustomStat(names.ProxyUpdates, category, nProxyUpdates, ECsvCustomStatOp::Accumulate);
+	FCsvProfiler::RecordCustomStat(names.ProxyBytes, category, nProxyBytes, ECsvCustomStatOp::Accumulate);
+	FCsvProfiler::RecordCustomStat(names.OversizedProxies, category, nOversizedProxies, ECsvCustomStatOp::Accumulate);
+	FCsvProfiler::RecordCustomStat(names.RenderCommands, category, nRenderCommands, ECsvCustomStatOp::Accumulate);
+	FCsvProfiler::RecordCustomStat(names.ViewFilterRejects, category, nRejects, ECsvCustomStatOp::Accumulate);
+#endif
+}
+void U_EGP_RenderPass::ApplyProxyUpdates_RenderThread(const EGP::CustomRenderPasses::FProxyUpdateBatch& batch)
+{
+	check(IsInRenderingThread());
+	TRACE_CPUPROFILER_EVENT_SCOPE(EGP_ApplyCustomPassProxies);
+
+	//Registration changes are sent immediately rather than batched,
+	//    so every slot in this batch is guaranteed to still belong to the component that wrote it.
+	for (const auto& entry : batch.Entries)
+	{
+		ComponentProxies_RenderThread.Write(entry.Slot, entry.Target,
+											batch.Bytes.GetData() + entry.ByteOffset,
+											entry.ByteCount);
+		if (mirrorProxiesToGPU_RenderThread)
+			gpuDirtySlots_RenderThread.Add(entry.Slot);
+	}
+}
+EGP::CustomRenderPasses::FProxyGPUBuffer U_EGP_RenderPass::GetProxyBuffer_RenderThread(FRDGBuilder& graph)
+{
+	check(IsInRenderingThread());
+	if (!mirrorProxiesToGPU_RenderThread)
+		return { };
+
+	const auto& storage = ComponentProxies_RenderThread;
+	const int32 stride = FMath::Max(storage.GetProxyStride(), EGP::CustomRenderPasses::ProxyAlignment);
+	const int32 nSlots = storage.NumSlots();
+	//Buffers can't be empty, but the padding slot isn't reported to consumers.
+	const int32 nBufferSlots = FMath::Max(nSlots, 1);
+
+	//If the stride changed then the whole buffer is laid out differently.
+	if (stride != gpuProxyStride_RenderThread)
+	{
+		gpuProxyStride_RenderThread = stride;
+		for (int32 i = 0; i < storage.Num(); ++i)
+			gpuDirtySlots_RenderThread.Add(storage.GetSlot(i));
+	}
+
+	//Growing the buffer preserves its old contents, so existing slots don't need to be re-uploaded.
+	FRDGBuffer* buffer = ResizeByteAddressBufferIfNeeded(graph, gpuProxies_RenderThread,
+														  nBufferSlots * stride, TEXT("EGP.CustomPassProxies"));
+
+	//Scatter only the changed slots into the buffer.
+	//Empty proxy structs have nothing to upload.
+	if (gpuDirtySlots_RenderThread.Num() > 0 && storage.GetProxyStride() > 0)
+	{
+		TRACE_CPUPROFILER_EVENT_SCOPE(EGP_UploadCustomPassProxies);
+
+		FRDGScatterUploadBuffer uploader;
+		uploader.Init(graph, gpuDirtySlots_RenderThread.Num(), stride, false, TEXT("EGP.CustomPassProxiesUpload"));
+		for (int32 slot : gpuDirtySlots_RenderThread)
+		{
+			//Skip components that unregistered after their proxy changed.
+			int32 denseIdx = storage.GetDenseIndex(slot);
+			if (denseIdx != INDEX_NONE)
+				uploader.Add(slot, storage.GetProxy(denseIdx));
+		}
+		uploader.ResourceUploadTo(graph, buffer);
+	}
+	gpuDirtySlots_RenderThread.Reset();
+
+	//Primitives get new ID's as other primitives enter and leave the scene, and their bounds change as they move,
+	//    so check every slot but only upload the ones that changed.
+	//Slots without a primitive get invalid bounds, so that culling skips them.
+	gpuSlotPrimitives_RenderThread.SetNum(storage.NumSlots());
+	TArray<TPair<int32, uint32>> movedPrimitives;
+	TArray<int32> changedBounds;
+	int32 nPrimitives = 1;
+	for (int32 slot = 0; slot < storage.NumSlots(); ++slot)
+	{
+		const int32 denseIdx = storage.GetDenseIndex(slot);
+		const auto* primitiveComponent = (denseIdx == INDEX_NONE) ? nullptr : storage.GetElement(denseIdx).Target.Get();
+		const auto* primitiveProxy = (primitiveComponent == nullptr) ? nullptr : primitiveComponent->SceneProxy;
+		const auto* sceneInfo = (primitiveProxy == nullptr) ? nullptr : primitiveProxy->GetPrimitiveSceneInfo();
+
+		FGPUSlotPrimitive current;
+		if (sceneInfo != nullptr && sceneInfo->IsIndexValid())
+		{
+			const auto& bounds = primitiveProxy->GetBounds();
+			current.PrimitiveIdx = sceneInfo->GetIndex();
+			current.Sphere = FVector4f(FVector3f(bounds.Origin), static_cast<float>(bounds.SphereRadius));
+			current.Extent = FVector3f(bounds.BoxExtent);
+			nPrimitives = FMath::Max(nPrimitives, current.PrimitiveIdx + 1);
+		}
+		current.IsUploaded = true;
+
+		auto& uploaded = gpuSlotPrimitives_RenderThread[slot];
+		if (uploaded.IsUploaded && uploaded.PrimitiveIdx == current.PrimitiveIdx &&
+			uploaded.Sphere == current.Sphere && uploaded.Extent == current.Extent)
+		{
+			continue;
+		}
+
+		changedBounds.Add(slot);
+		if (current.PrimitiveIdx != INDEX_NONE && (!uploaded.IsUploaded || uploaded.PrimitiveIdx != current.PrimitiveIdx))
+			movedPrimitives.Emplace(current.PrimitiveIdx, static_cast<uint32>(slot));
+		uploaded = current;
+	}
+
+	FRDGBuffer* primitiveSlots = ResizeByteAddressBufferIfNeeded(graph, gpuPrimitiveSlots_RenderThread,
+																  FMath::RoundUpToPowerOfTwo(nPrimitives) * sizeof(uint32),
+																  TEXT("EGP.CustomPassPrimitiveSlots"));
+	if (movedPrimitives.Num() > 0)
+	{
+		FRDGScatterUploadBuffer uploader;
+		uploader.Init(graph, movedPrimitives.Num(), sizeof(uint32), false, TEXT("EGP.CustomPassPrimitiveSlotsUpload"));
+		for (const auto& [primitiveIdx, slot] : movedPrimitives)
+			uploader.Add(primitiveIdx, &slot);
+		uploader.ResourceUploadTo(graph, primitiveSlots);
+	}
+
+	FRDGBuffer* slotBounds = ResizeByteAddressBufferIfNeeded(graph, gpuSlotBounds_RenderThread,
+															  nBufferSlots * EGP::CustomRenderPasses::FProxyGPUBuffer::BoundsStride,
+															  TEXT("EGP.CustomPassBounds"));
+	if (changedBounds.Num() > 0)
+	{
+		FRDGScatterUploadBuffer uploader;
+		uploader.Init(graph, changedBounds.Num(), EGP::CustomRenderPasses::FProxyGPUBuffer::BoundsStride,
+					  false, TEXT("EGP.CustomPassBoundsUpload"));
+		for (int32 slot : changedBounds)
+		{
+			const auto& uploaded = gpuSlotPrimitives_RenderThread[slot];
+			const FVector4f data[2] = { uploaded.Sphere, FVector4f(uploaded.Extent, 0.0f) };
+			uploader.Add(slot, data);
+		}
+		uploader.ResourceUploadTo(graph, slotBounds);
+	}
+
+	return { graph.CreateSRV(buffer), static_cast<uint32>(stride), static_cast<uint32>(nSlots),
+			 graph.CreateSRV(primitiveSlots), graph.CreateSRV(slotBounds) };
+}
+void U_EGP_RenderPass::ReleaseComponents_RenderThread()
+{
+	check(IsInRenderingThread());
+
+	auto& storage = ComponentProxies_RenderThread;
+	for (int32 i = 0; i < storage.Num(); ++i)
+	{
+		const auto* component = storage.GetElement(i).Component;
+		component->renderThreadPass = nullptr;
+		component->renderThreadSlot = INDEX_NONE;
+	}
+	storage = { };
+
+	gpuProxies_RenderThread.SafeRelease();
+	gpuDirtySlots_RenderThread.Empty();
+	gpuPrimitiveSlots_RenderThread.SafeRelease();
+	gpuSlotBounds_RenderThread.SafeRelease();
+	gpuSlotPrimitives_RenderThread.Empty();
+}
+void U_EGP_RenderPass::Tick_RenderThread(const FSceneInterface& thisScene, float gameThreadDeltaSeconds)
 {
 	
 }
 void U_EGP_RenderPass::RegisterPassComponent(U_EGP_RenderPassComponent* component)
 {
 	check(IsInGameThread());
-	Components_GameThread.Add(component);
+
+	bool alreadyRegistered;
+	Components_GameThread.Add(component, &alreadyRegistered);
+	if (alreadyRegistered)
+		return;
+
+	//The first proxy will be sent with the next batch.
+	component->MarkProxyDirty();
+	component->lastSentTarget = nullptr;
+	if (TimeSliceProxyUpdates)
+		timeSliceNewComponents_GameThread.Add(component);
+	timeSliceOrderIsDirty_GameThread = true;
+
+	//Every component in a pass is expected to use the same proxy struct.
+	int32 proxySize = component->GetProxyByteSize();
+	if (proxyByteSize_GameThread == INDEX_NONE)
+		proxyByteSize_GameThread = proxySize;
+	else if (proxySize != proxyByteSize_GameThread && !warnedAboutProxySizeMismatch)
+	{
+		UE_LOG(LogEGP, Warning,
+			   TEXT("Custom render pass '%s' has components with different proxy sizes (%i and %i)! "
+					  "Every component in a pass should use the same proxy struct."),
+			   *GetName(), proxyByteSize_GameThread, proxySize);
+		warnedAboutProxySizeMismatch = true;
+	}
+
+	//Give the component a slot in the proxy storage.
+	int32 slot = freeSlots_GameThread.IsEmpty() ? nSlots_GameThread++ : freeSlots_GameThread.Pop(false);
+	component->gameThreadSlot = slot;
+
+	auto* _this = this;
+	nRenderCommands_GameThread += 1;
+	ENQUEUE_RENDER_COMMAND(RegisterCustomPassComponent)([_this, component, slot, proxySize](FRHICommandListImmediate&)
+	{
+		_this->ComponentProxies_RenderThread.Add(slot, component, proxySize);
+		//The slot may have belonged to another component, so its primitive needs to be uploaded again.
+		if (_this->gpuSlotPrimitives_RenderThread.IsValidIndex(slot))
+			_this->gpuSlotPrimitives_RenderThread[slot].IsUploaded = false;
+		component->renderThreadPass = _this;
+		component->renderThreadSlot = slot;
+	});
 }
 void U_EGP_RenderPass::UnregisterPassComponent(U_EGP_RenderPassComponent* component)
 {
 	check(IsInGameThread());
-	Components_GameThread.Remove(component);
+	if (Components_GameThread.Remove(component) == 0)
+		return;
+	timeSliceNewComponents_GameThread.RemoveSwap(component, false);
+	timeSliceOrderIsDirty_GameThread = true;
+
+	int32 slot = component->gameThreadSlot;
+	component->gameThreadSlot = INDEX_NONE;
+	freeSlots_GameThread.Add(slot);
+
+	//Unregistering immediately (rather than with the next batch) guarantees
+	//    the render thread lets go of the component before its destruction fence.
+	auto* _this = this;
+	nRenderCommands_GameThread += 1;
+	ENQUEUE_RENDER_COMMAND(UnregisterCustomPassComponent)([_this, component, slot](FRHICommandListImmediate&)
+	{
+		_this->ComponentProxies_RenderThread.Remove(slot);
+		component->renderThreadPass = nullptr;
+		component->renderThreadSlot = INDEX_NONE;
+	});
 }
 
 
@@ -221,7 +825,26 @@ void U_EGP_RenderPassSubsystem::Tick(float deltaSeconds)
 	for (const auto& [type, pass] : passes)
 		passBuffer.Add(pass);
 	for (auto pass : passBuffer)
-		pass->Tick_GameThread(*world, deltaSeconds);
+	{
+		//Send this frame's filter changes along before the render thread uses them.
+		//Done even for throttled passes, so views are never filtered late.
+		pass->ViewFilter->SyncToRenderThread();
+
+		//Throttled passes accumulate time until they're due, then see all of it in one tick.
+		pass->secondsSinceTick_GameThread += deltaSeconds;
+		if (pass->hasTicked_GameThread && pass->MaxTicksPerSecond > 0 &&
+			pass->secondsSinceTick_GameThread < (1.0f / pass->MaxTicksPerSecond))
+		{
+			//Keep the stats steady between ticks.
+			pass->ReportStats_GameThread(nullptr, 0);
+			continue;
+		}
+
+		const float passDeltaSeconds = pass->secondsSinceTick_GameThread;
+		pass->secondsSinceTick_GameThread = 0;
+		pass->hasTicked_GameThread = true;
+		pass->Tick_GameThread(*world, passDeltaSeconds);
+	}
 	passBuffer.Empty();
 }
 void U_EGP_RenderPassSubsystem::BeginDestroy()
@@ -310,8 +933,127 @@ bool U_EGP_RenderPassSubsystem::DestroyPass_Impl_GameThread(TSubclassOf<U_EGP_Re
 	ENQUEUE_RENDER_COMMAND(CleanupPass)([world, pass, isExternalCall](FRHICommandListImmediate& cmds)
 	{
 		pass->CleanupThisPass_RenderThread(*world, isExternalCall);
+		pass->ReleaseComponents_RenderThread();
 	});
 	fence->BeginFence();
 	
 	return true;
-}
\ No newline at end of file
+}
+
+
+//The renderer only ever hands its own view type to these hooks.
+void F_EGP_RenderPassSceneViewExtension::PreRenderView_RenderThread(FRDGBuilder& graph, FSceneView& view)
+{
+	OnPreRenderView_RenderThread(graph, view);
+	if (ComputeScheduling == E_EGP_ComputeScheduling::BeforeScene)
+		AddComputePasses_RenderThread(graph, static_cast<const FViewInfo&>(view));
+}
+void F_EGP_RenderPassSceneViewExtension::PostRenderBasePassDeferred_RenderThread(FRDGBuilder& graph, FSceneView& view,
+																				 const FRenderTargetBindingSlots& renderTargets,
+																				 TRDGUniformBufferRef<FSceneTextureUniformParameters> sceneTextures)
+{
+	OnPostRenderBasePassDeferred_RenderThread(graph, view, renderTargets, sceneTextures);
+	if (ComputeScheduling == E_EGP_ComputeScheduling::AfterBasePass)
+		AddComputePasses_RenderThread(graph, static_cast<const FViewInfo&>(view));
+}
+void F_EGP_RenderPassSceneViewExtension::PrePostProcessPass_RenderThread(FRDGBuilder& graph, const FSceneView& view,
+																		 const FPostProcessingInputs& inputs)
+{
+	OnPrePostProcessPass_RenderThread(graph, view, inputs);
+	if (ComputeScheduling == E_EGP_ComputeScheduling::BeforePostProcess)
+		AddComputePasses_RenderThread(graph, static_cast<const FViewInfo&>(view));
+}
+
+
+FRDGTextureRef F_EGP_ViewResourcePool::CreateTexture(FRDGBuilder& graph, const FRDGTextureDesc& desc, const TCHAR* name,
+													 TRefCountPtr<IPooledRenderTarget>& outPersistent)
+{
+	check(IsInRenderingThread());
+
+	//Prefer the newest match, as it's the most likely to still be resident.
+	for (int32 i = entries.Num() - 1; i >= 0; --i)
+	{
+		if (entries[i].Texture.IsValid() && entries[i].Texture->GetDesc() == desc)
+		{
+			outPersistent = MoveTemp(entries[i].Texture);
+			RemoveEntry(i);
+			return graph.RegisterExternalTexture(outPersistent, name);
+		}
+	}
+
+	outPersistent = AllocatePooledTexture(desc, name);
+	return graph.RegisterExternalTexture(outPersistent, name);
+}
+FRDGBufferRef F_EGP_ViewResourcePool::CreateBuffer(FRDGBuilder& graph, const FRDGBufferDesc& desc, const TCHAR* name,
+												   TRefCountPtr<FRDGPooledBuffer>& outPersistent)
+{
+	check(IsInRenderingThread());
+
+	for (int32 i = entries.Num() - 1; i >= 0; --i)
+	{
+		if (entries[i].Buffer.IsValid() && entries[i].Buffer->Desc == desc)
+		{
+			outPersistent = MoveTemp(entries[i].Buffer);
+			RemoveEntry(i);
+			return graph.RegisterExternalBuffer(outPersistent, name);
+		}
+	}
+
+	outPersistent = AllocatePooledBuffer(desc, name);
+	return graph.RegisterExternalBuffer(outPersistent, name);
+}
+void F_EGP_ViewResourcePool::Return(TRefCountPtr<IPooledRenderTarget>& texture)
+{
+	check(IsInRenderingThread());
+	if (!texture.IsValid())
+		return;
+
+	auto& entry = entries.Emplace_GetRef();
+	entry.ByteSize = GetByteSize(texture);
+	entry.Texture = MoveTemp(texture);
+	nBytes += entry.ByteSize;
+}
+void F_EGP_ViewResourcePool::Return(TRefCountPtr<FRDGPooledBuffer>& buffer)
+{
+	check(IsInRenderingThread());
+	if (!buffer.IsValid())
+		return;
+
+	auto& entry = entries.Emplace_GetRef();
+	entry.ByteSize = GetByteSize(buffer);
+	entry.Buffer = MoveTemp(buffer);
+	nBytes += entry.ByteSize;
+}
+void F_EGP_ViewResourcePool::Tick()
+{
+	check(IsInRenderingThread());
+	for (int32 i = entries.Num() - 1; i >= 0; --i)
+	{
+		if (entries[i].FramesInPool > CleanupFrameThreshold)
+			RemoveEntry(i);
+		else
+			entries[i].FramesInPool += 1;
+	}
+}
+void F_EGP_ViewResourcePool::Trim(uint64 maxBytes)
+{
+	check(IsInRenderingThread());
+
+	int32 nToRemove = 0;
+	for (uint64 remainingBytes = nBytes; nToRemove < entries.Num() && remainingBytes > maxBytes; ++nToRemove)
+		remainingBytes -= entries[nToRemove].ByteSize;
+
+	for (int32 i = 0; i < nToRemove; ++i)
+		nBytes -= entries[i].ByteSize;
+	entries.RemoveAt(0, nToRemove);
+}
+void F_EGP_ViewResourcePool::Empty()
+{
+	entries.Empty();
+	nBytes = 0;
+}
+void F_EGP_ViewResourcePool::RemoveEntry(int32 i)
+{
+	nBytes -= entries[i].ByteSize;
+	entries.RemoveAt(i);
+}
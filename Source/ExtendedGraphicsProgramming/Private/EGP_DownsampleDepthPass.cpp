@@ -1,6 +1,7 @@
 #include "EGP_DownsampleDepthPass.h"
 
 #include "DataDrivenShaderPlatformInfo.h"
+#include "RenderGraphUtils.h"
 #include "Runtime/Renderer/Private/SceneRendering.h"
 
 
@@ -9,6 +10,9 @@
 #pragma warning( push, 0 )
 // ReSharper disable All
 
+//NOTE: not in the original unreal code
+DECLARE_GPU_STAT_NAMED(EGP_DownsampleDepth, TEXT("EGP Downsample Depth"));
+
 class FEGPDownsampleDepthPS : public FGlobalShader
 {
 public:
@@ -43,6 +47,9 @@ void EGP::AddDownsampleDepthPass(FRDGBuilder& GraphBuilder, const FViewInfo& Vie
                                   FScreenPassTexture Input, FScreenPassRenderTarget Output,
                                   EDownsampleDepthFilter DownsampleDepthFilter)
 {
+	//NOTE: not in the original unreal code
+	RDG_GPU_STAT_SCOPE(GraphBuilder, EGP_DownsampleDepth);
+
 	const FScreenPassTextureViewport InputViewport(Input);
 	const FScreenPassTextureViewport OutputViewport(Output);
 
@@ -106,3 +113,103 @@ void EGP::AddDownsampleDepthPass(FRDGBuilder& GraphBuilder, const FViewInfo& Vie
 }
 
 #pragma warning( pop )
+
+
+class FEGPDownsampleDepthCS : public FGlobalShader
+{
+public:
+	DECLARE_GLOBAL_SHADER(FEGPDownsampleDepthCS);
+	SHADER_USE_PARAMETER_STRUCT(FEGPDownsampleDepthCS, FGlobalShader);
+
+	static constexpr int32 MaxJobs = 4,
+						   GroupSize = 8;
+
+	class FFilter : SHADER_PERMUTATION_INT("DOWNSAMPLE_DEPTH_FILTER", 4);
+	using FPermutationDomain = TShaderPermutationDomain<FFilter>;
+
+	BEGIN_SHADER_PARAMETER_STRUCT(FParameters, )
+		SHADER_PARAMETER(uint32, NumJobs)
+		SHADER_PARAMETER_ARRAY(FIntVector4, SrcRects, [MaxJobs])
+		SHADER_PARAMETER_ARRAY(FIntVector4, DstRects, [MaxJobs])
+		SHADER_PARAMETER_ARRAY(FVector4f, DstToSrcPixelScales, [MaxJobs])
+		SHADER_PARAMETER_RDG_TEXTURE_ARRAY(Texture2D, DepthTexture, [MaxJobs])
+		SHADER_PARAMETER_RDG_TEXTURE_UAV_ARRAY(RWTexture2D<float>, RWOutput, [MaxJobs])
+	END_SHADER_PARAMETER_STRUCT()
+
+	static bool ShouldCompilePermutation(const FGlobalShaderPermutationParameters& Parameters)
+	{
+		return IsFeatureLevelSupported(Parameters.Platform, ERHIFeatureLevel::SM5);
+	}
+};
+IMPLEMENT_GLOBAL_SHADER(FEGPDownsampleDepthCS, "/EGP/DownsampleDepth/downsample_depth_cs.usf", "DownsampleDepthCS", SF_Compute);
+
+void EGP::AddDownsampleDepthComputePass(FRDGBuilder& builder, ERHIFeatureLevel::Type featureLevel,
+										TConstArrayView<FDownsampleDepthJob> jobs,
+										EDownsampleDepthFilter sampling, bool asyncCompute)
+{
+	if (jobs.Num() == 0)
+		return;
+
+	const ERDGPassFlags flags = asyncCompute ? ERDGPassFlags::AsyncCompute : ERDGPassFlags::Compute;
+	const EPixelFormat outputFormat = (sampling == EDownsampleDepthFilter::MinAndMaxDepth) ? PF_G32R32F : PF_R32_FLOAT;
+
+	FEGPDownsampleDepthCS::FPermutationDomain permutation;
+	permutation.Set<FEGPDownsampleDepthCS::FFilter>(static_cast<int32>(sampling));
+	TShaderMapRef<FEGPDownsampleDepthCS> shader(GetGlobalShaderMap(featureLevel), permutation);
+
+	RDG_EVENT_SCOPE(builder, "EGP::DownsampleDepthCompute(%i jobs)", jobs.Num());
+	RDG_GPU_STAT_SCOPE(builder, EGP_DownsampleDepth);
+
+	//Unused job slots still need something bound; the shader never touches them.
+	FRDGTextureUAVRef unusedOutputUAV = nullptr;
+
+	for (int32 firstJob = 0; firstJob < jobs.Num(); firstJob += FEGPDownsampleDepthCS::MaxJobs)
+	{
+		const int32 nJobs = FMath::Min(jobs.Num() - firstJob, FEGPDownsampleDepthCS::MaxJobs);
+		auto* params = builder.AllocParameters<FEGPDownsampleDepthCS::FParameters>();
+		params->NumJobs = static_cast<uint32>(nJobs);
+
+		FIntPoint maxOutputSize{ 1, 1 };
+		for (int32 i = 0; i < FEGPDownsampleDepthCS::MaxJobs; ++i)
+		{
+			if (i >= nJobs)
+			{
+				if (unusedOutputUAV == nullptr)
+				{
+					auto dummy = builder.CreateTexture(
+						FRDGTextureDesc::Create2D({ 1, 1 }, outputFormat, FClearValueBinding::None, TexCreate_UAV),
+						TEXT("EGP.DownsampleDepthUnusedOutput")
+					);
+					unusedOutputUAV = builder.CreateUAV(dummy);
+				}
+				params->DepthTexture[i] = jobs[firstJob].Input.Texture;
+				params->RWOutput[i] = unusedOutputUAV;
+				continue;
+			}
+
+			const auto& job = jobs[firstJob + i];
+			const FIntRect& srcRect = job.Input.ViewRect,
+						  & dstRect = job.Output.ViewRect;
+			check(EnumHasAnyFlags(job.Output.Texture->Desc.Flags, TexCreate_UAV));
+
+			//Like the pixel-shader version above, the scale uses the view rects rather than the texture extents,
+			//    so that depth buffers bigger than their view (e.g. from Scene Captures) work correctly.
+			params->SrcRects[i] = FIntVector4(srcRect.Min.X, srcRect.Min.Y, srcRect.Max.X - 1, srcRect.Max.Y - 1);
+			params->DstRects[i] = FIntVector4(dstRect.Min.X, dstRect.Min.Y, dstRect.Max.X, dstRect.Max.Y);
+			params->DstToSrcPixelScales[i] = FVector4f(
+				static_cast<float>(srcRect.Width()) / static_cast<float>(dstRect.Width()),
+				static_cast<float>(srcRect.Height()) / static_cast<float>(dstRect.Height()),
+				0, 0
+			);
+			params->DepthTexture[i] = job.Input.Texture;
+			params->RWOutput[i] = builder.CreateUAV(job.Output.Texture);
+
+			maxOutputSize = maxOutputSize.ComponentMax(dstRect.Size());
+		}
+
+		FIntVector groupCount = FComputeShaderUtils::GetGroupCount(maxOutputSize, FEGPDownsampleDepthCS::GroupSize);
+		groupCount.Z = nJobs;
+		FComputeShaderUtils::AddPass(builder, RDG_EVENT_NAME("Jobs %i-%i", firstJob, firstJob + nJobs - 1),
+									 flags, shader, params, groupCount);
+	}
+}
@@ -1,5 +1,9 @@
 #include "EGP_GetMaterialShader.h"
 
+#include "Async/Async.h"
+#include "MaterialShared.h"
+#include "PostProcess/PostProcessMaterialInputs.h"
+
 
 TOptional<EGP::FShaderMapFindResult> EGP::FindMaterialShaders_RenderThread(const UMaterialInterface* uMaterial,
 										  								   const FMaterialShaderTypes& shaderTypes,
@@ -8,3 +12,237 @@ TOptional<EGP::FShaderMapFindResult> EGP::FindMaterialShaders_RenderThread(const
 	return FindMaterialShaders_RenderThread(uMaterial, shaderTypes, settings,
 											[&](const FShaderMapFindCandidate&) { return true; });
 }
+
+
+namespace
+{
+	//Cached shader lookups are dropped after this many frames without being used.
+	constexpr uint64 ShaderCacheTimeoutFrames = 300;
+
+	struct FShaderCacheKey
+	{
+		const FMaterialRenderProxy* Proxy = nullptr;
+		ERHIFeatureLevel::Type FeatureLevel = ERHIFeatureLevel::Num;
+		int32 Domain = INDEX_NONE;
+		const FVertexFactoryType* VertexFactory = nullptr;
+		const FShaderPipelineType* PipelineType = nullptr;
+		const FShaderType* ShaderTypes[SF_NumFrequencies] = { };
+		int32 PermutationIDs[SF_NumFrequencies] = { };
+
+		bool operator==(const FShaderCacheKey& k) const
+		{
+			return Proxy == k.Proxy && FeatureLevel == k.FeatureLevel && Domain == k.Domain &&
+				   VertexFactory == k.VertexFactory && PipelineType == k.PipelineType &&
+				   FMemory::Memcmp(ShaderTypes, k.ShaderTypes, sizeof(ShaderTypes)) == 0 &&
+				   FMemory::Memcmp(PermutationIDs, k.PermutationIDs, sizeof(PermutationIDs)) == 0;
+		}
+		friend uint32 GetTypeHash(const FShaderCacheKey& k)
+		{
+			uint32 hash = HashCombine(GetTypeHash(k.Proxy), GetTypeHash(k.VertexFactory));
+			hash = HashCombine(hash, GetTypeHash(static_cast<int32>(k.FeatureLevel) | (k.Domain << 8)));
+			hash = HashCombine(hash, GetTypeHash(k.PipelineType));
+			for (int32 i = 0; i < SF_NumFrequencies; ++i)
+				if (k.ShaderTypes[i] != nullptr)
+					hash = HashCombine(hash, HashCombine(GetTypeHash(k.ShaderTypes[i]), GetTypeHash(k.PermutationIDs[i])));
+			return hash;
+		}
+	};
+	struct FShaderCacheValue
+	{
+		EGP::FShaderMapFindResult Result;
+		//The Material (and shader map) that the original proxy had at lookup time.
+		//If either changes (e.g. it finished compiling), the lookup must be redone.
+		//Pointers can be reused after they're freed, so the shader maps' ID's are compared too.
+		const FMaterial* RootMaterial = nullptr;
+		const FMaterialShaderMap* RootShaderMap = nullptr;
+		TOptional<FMaterialShaderMapId> RootShaderMapId;
+		FMaterialShaderMapId ResultShaderMapId;
+		uint64 LastUsedFrame = 0;
+	};
+
+	//Checks a cached result against the live Materials, without touching anything the cache remembers
+	//    (which may have been freed since).
+	bool IsCachedShaderLookupValid(const FShaderCacheValue& cached, const FMaterialRenderProxy* rootProxy,
+								   ERHIFeatureLevel::Type featureLevel)
+	{
+		const FMaterial* rootMaterial = rootProxy->GetMaterialNoFallback(featureLevel);
+		const FMaterialShaderMap* rootShaderMap = (rootMaterial == nullptr) ? nullptr : rootMaterial->GetRenderingThreadShaderMap();
+		if (rootMaterial != cached.RootMaterial || rootShaderMap != cached.RootShaderMap ||
+			(rootShaderMap != nullptr && (!cached.RootShaderMapId.IsSet() ||
+										  !(rootShaderMap->GetShaderMapId() == *cached.RootShaderMapId))))
+		{
+			return false;
+		}
+
+		//Walk the live fallback chain to the proxy that provided the result, so it's known to still exist.
+		for (const FMaterialRenderProxy* proxy = rootProxy; proxy != nullptr; proxy = proxy->GetFallback(featureLevel))
+		{
+			if (proxy != cached.Result.MaterialProxy)
+				continue;
+
+			const FMaterial* material = proxy->GetMaterialNoFallback(featureLevel);
+			const FMaterialShaderMap* shaderMap = (material == nullptr) ? nullptr : material->GetRenderingThreadShaderMap();
+			return material == cached.Result.Material &&
+				   shaderMap != nullptr && shaderMap == cached.Result.Map &&
+				   shaderMap->GetShaderMapId() == cached.ResultShaderMapId;
+		}
+		return false;
+	}
+
+	uint32 GetUsedPostProcessInputs(const FMaterialShaderMap* shaderMap)
+	{
+		uint32 mask = 0;
+		for (int32 i = 0; i < kPostProcessMaterialInputCountMax; ++i)
+			if (shaderMap->UsesSceneTexture(PPI_PostProcessInput0 + i))
+				mask |= (1u << i);
+		return mask;
+	}
+
+	struct FShaderCache
+	{
+		TMap<FShaderCacheKey, FShaderCacheValue> Entries;
+		uint64 LastCleanupFrame = 0;
+	};
+	FShaderCache& GetShaderCache()
+	{
+		check(IsInRenderingThread());
+		static FShaderCache cache;
+		return cache;
+	}
+}
+
+TOptional<EGP::FShaderMapFindResult> EGP::FindMaterialShadersCached_RenderThread(const UMaterialInterface* uMaterial,
+																				  const FMaterialShaderTypes& shaderTypes,
+																				  FShaderMapFindSettings settings)
+{
+	check(IsInRenderingThread());
+	auto& cache = GetShaderCache();
+	const uint64 frame = GFrameCounterRenderThread;
+
+	//Once per frame, drop entries that haven't been used in a while.
+	if (frame != cache.LastCleanupFrame)
+	{
+		cache.LastCleanupFrame = frame;
+		for (auto it = cache.Entries.CreateIterator(); it; ++it)
+			if (frame - it->Value.LastUsedFrame > ShaderCacheTimeoutFrames)
+				it.RemoveCurrent();
+	}
+
+	//Mirror the default-Material logic of the uncached version, so the key is always a real proxy.
+	const UMaterialInterface* rootMaterial = uMaterial;
+	if (rootMaterial == nullptr)
+		if (settings.Domain.IsSet())
+			rootMaterial = UMaterial::GetDefaultMaterial(*settings.Domain);
+		else
+			return NullOpt;
+	const FMaterialRenderProxy* rootProxy = rootMaterial->GetRenderProxy();
+	check(rootProxy);
+
+	FShaderCacheKey key;
+	key.Proxy = rootProxy;
+	key.FeatureLevel = settings.FeatureLevel;
+	key.Domain = settings.Domain.IsSet() ? static_cast<int32>(*settings.Domain) : INDEX_NONE;
+	key.VertexFactory = settings.VertexFactory;
+	key.PipelineType = shaderTypes.PipelineType;
+	for (int32 i = 0; i < SF_NumFrequencies; ++i)
+	{
+		key.ShaderTypes[i] = shaderTypes.ShaderType[i];
+		key.PermutationIDs[i] = shaderTypes.PermutationId[i];
+	}
+
+	//Use the cached result if the Materials involved haven't changed since then.
+	if (auto* cached = cache.Entries.Find(key))
+	{
+		if (IsCachedShaderLookupValid(*cached, rootProxy, settings.FeatureLevel))
+		{
+			cached->LastUsedFrame = frame;
+			return cached->Result;
+		}
+	}
+
+	//Do the full lookup and remember it.
+	//Failures aren't cached, as they're usually just waiting on shader compilation.
+	auto result = FindMaterialShaders_RenderThread(rootMaterial, shaderTypes, settings);
+	if (result.IsSet())
+	{
+		//Computed here rather than per-pass, and validated along with the rest of the lookup.
+		result->UsedPostProcessInputs = GetUsedPostProcessInputs(result->Map);
+
+		FShaderCacheValue value;
+		value.Result = *result;
+		value.RootMaterial = rootProxy->GetMaterialNoFallback(settings.FeatureLevel);
+		value.RootShaderMap = (value.RootMaterial == nullptr) ? nullptr : value.RootMaterial->GetRenderingThreadShaderMap();
+		if (value.RootShaderMap != nullptr)
+			value.RootShaderMapId = value.RootShaderMap->GetShaderMapId();
+		value.ResultShaderMapId = result->Map->GetShaderMapId();
+		value.LastUsedFrame = frame;
+		cache.Entries.Add(key, MoveTemp(value));
+	}
+	else
+		cache.Entries.Remove(key);
+	return result;
+}
+namespace
+{
+	//Asks the game thread to compile the given shaders for the Material, if its shader map is done and lacks them.
+	//Only possible in the editor; cooked builds can only use the shaders they shipped with.
+	void RequestMissingShaders(const UMaterialInterface* uMaterial, const FMaterialShaderTypes& shaderTypes,
+							   const EGP::FShaderMapFindSettings& settings)
+	{
+	#if WITH_EDITOR
+		if (uMaterial == nullptr)
+			return;
+
+		//The vertex-factory list pairs up with the shader-type list.
+		TArray<const FShaderType*> types;
+		TArray<const FVertexFactoryType*> vertexFactories;
+		for (int32 i = 0; i < SF_NumFrequencies; ++i)
+		{
+			if (shaderTypes.ShaderType[i] != nullptr)
+			{
+				types.Add(shaderTypes.ShaderType[i]);
+				vertexFactories.Add(settings.VertexFactory);
+			}
+		}
+		TArray<const FShaderPipelineType*> pipelines;
+		if (shaderTypes.PipelineType != nullptr)
+			pipelines.Add(shaderTypes.PipelineType);
+
+		TWeakObjectPtr<UMaterialInterface> material = const_cast<UMaterialInterface*>(uMaterial);
+		const auto featureLevel = settings.FeatureLevel;
+		AsyncTask(ENamedThreads::GameThread, [material, featureLevel, types = MoveTemp(types),
+											  vertexFactories = MoveTemp(vertexFactories), pipelines = MoveTemp(pipelines)]()
+		{
+			auto* materialPtr = material.Get();
+			auto* resource = (materialPtr == nullptr) ? nullptr : materialPtr->GetMaterialResource(featureLevel);
+
+			//A shader map that's still compiling will bring its shaders along when it finishes.
+			if (resource == nullptr || !resource->IsCompilationFinished())
+				return;
+			resource->CacheGivenTypes(GShaderPlatformForFeatureLevel[featureLevel], vertexFactories, pipelines, types);
+		});
+	#endif
+	}
+}
+bool EGP::PrecacheMaterialShaders_RenderThread(const UMaterialInterface* uMaterial,
+											   const FMaterialShaderTypes& shaderTypes,
+											   FShaderMapFindSettings settings)
+{
+	auto found = FindMaterialShadersCached_RenderThread(uMaterial, shaderTypes, settings);
+	if (!found)
+	{
+		RequestMissingShaders(uMaterial, shaderTypes, settings);
+		return false;
+	}
+
+	//Shaders are usually created lazily when first bound, which is where the hitch comes from.
+	for (int32 i = 0; i < SF_NumFrequencies; ++i)
+		if (FShader* shader = found->Shaders.Shaders[i])
+			TShaderRef<FShader>(shader, *found->Shaders.ShaderMap).GetRHIShaderBase(static_cast<EShaderFrequency>(i));
+
+	return true;
+}
+void EGP::ClearMaterialShaderCache_RenderThread()
+{
+	GetShaderCache().Entries.Empty();
+}
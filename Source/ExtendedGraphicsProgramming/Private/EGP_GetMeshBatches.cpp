@@ -29,3 +29,270 @@ FInt32Range EGP::GetDynamicMeshElementRange(const FViewInfo& info, uint32 primit
 
 	return FInt32Range::Empty();
 }
+
+FLODMask EGP::GetStaticMeshLODs(const FViewInfo& info, const FPrimitiveSceneInfo& sceneInfo)
+{
+	//Mirrors the LOD selection in the engine's 'FRelevancePacket::MarkRelevant()'.
+	const auto* proxy = sceneInfo.Proxy;
+	int32 forcedLOD = (info.Family->EngineShowFlags.LOD) ? GetCVarForceLOD() : 0;
+	forcedLOD = FMath::Max(forcedLOD, proxy->GetForcedLOD());
+
+	static const auto* lodDistanceScaleCVar = IConsoleManager::Get().FindTConsoleVariableDataFloat(TEXT("r.StaticMeshLODDistanceScale"));
+	float lodScale = info.LODDistanceFactor *
+					 ((lodDistanceScaleCVar == nullptr) ? 1.0f : lodDistanceScaleCVar->GetValueOnRenderThread());
+
+	const auto& bounds = proxy->GetBounds();
+	float screenRadiusSquared = 0;
+	return ComputeLODForMeshes(sceneInfo.StaticMeshRelevances, info,
+							   bounds.Origin, static_cast<float>(bounds.SphereRadius),
+							   forcedLOD, screenRadiusSquared,
+							   proxy->GetCurrentFirstLODIdx_RenderThread(), lodScale);
+}
+uint64 EGP::GetStaticMeshElementMask(const FViewInfo& info, const FStaticMeshBatch& staticMesh)
+{
+	//Most meshes draw all their elements; the rest had their visible elements computed during the visibility pass.
+	if (!staticMesh.bRequiresPerElementVisibility || !info.StaticMeshBatchVisibility.IsValidIndex(staticMesh.BatchVisibilityId))
+		return ~0ull;
+	return info.StaticMeshBatchVisibility[staticMesh.BatchVisibilityId];
+}
+
+
+class EGP::FCachedMeshDrawCommands::FCachingContext final : public FMeshPassDrawListContext
+{
+public:
+	FCachingContext(TArray<FCachedCommand>& output, int staticMeshIdx)
+		: output(output), staticMeshIdx(staticMeshIdx) { }
+
+	virtual FMeshDrawCommand& AddCommand(FMeshDrawCommand& initializer, uint32 numElements) override
+	{
+		auto& cached = output.Emplace_GetRef();
+		cached.Command = initializer;
+		cached.StaticMeshIdx = staticMeshIdx;
+		return cached.Command;
+	}
+	virtual void FinalizeCommand(const FMeshBatch& meshBatch, int32 batchElementIndex,
+								 const FMeshDrawCommandPrimitiveIdInfo& idInfo,
+								 ERasterizerFillMode meshFillMode, ERasterizerCullMode meshCullMode,
+								 FMeshDrawCommandSortKey sortKey, EFVisibleMeshDrawCommandFlags flags,
+								 const FGraphicsMinimalPipelineStateInitializer& pipelineState,
+								 const FMeshProcessorShaders* shadersForDebugging,
+								 FMeshDrawCommand& meshDrawCommand) override
+	{
+		//Commands are always finalized right after they're added.
+		auto& cached = output.Last();
+		check(&cached.Command == &meshDrawCommand);
+
+		//Cached commands outlive the frame, so they need a persistent pipeline ID.
+		cached.PipelineID = FGraphicsMinimalPipelineStateId::GetPersistentId(pipelineState);
+		meshDrawCommand.SetDrawParametersAndFinalize(meshBatch, batchElementIndex, cached.PipelineID, shadersForDebugging);
+
+		cached.BatchElementIdx = batchElementIndex;
+		cached.IdInfo = idInfo;
+		cached.FillMode = meshFillMode;
+		cached.CullMode = meshCullMode;
+		cached.SortKey = sortKey;
+		cached.Flags = flags;
+		cached.CullingPayload = CreateCullingPayload(meshBatch, meshBatch.Elements[batchElementIndex]);
+	}
+
+private:
+	TArray<FCachedCommand>& output;
+	const int staticMeshIdx;
+};
+
+EGP::FCachedMeshDrawCommands::~FCachedMeshDrawCommands()
+{
+	Reset();
+}
+
+void EGP::FCachedMeshDrawCommands::GatherStaticCommands(const FViewInfo& viewInfo, const FPrimitiveSceneInfo& sceneInfo,
+														FViewCommands& output,
+														TFunctionRef<void(FMeshPassDrawListContext*, const FMeshBatch&, int)> buildCommands)
+{
+	check(IsInParallelRenderingThread());
+	auto featureLevel = viewInfo.GetFeatureLevel();
+
+	FPrimitiveEntry* entryPtr;
+	{
+		FScopeLock lock(&entriesLock);
+		auto& entrySlot = entries.FindOrAdd(sceneInfo.GetPersistentIndex().Index);
+		if (!entrySlot.IsValid())
+			entrySlot = MakeUnique<FPrimitiveEntry>();
+		entryPtr = entrySlot.Get();
+	}
+
+	//Rebuild the primitive's commands if they're missing or out of date.
+	//Other views may already reference this frame's commands, so they're never rebuilt twice in one frame;
+	//    a change that shows up mid-frame is picked up next frame.
+	auto& entry = *entryPtr;
+	FScopeLock entryLock(&entry.Lock);
+	const bool usedThisFrame = (entry.LastUsedFrame == GFrameCounterRenderThread);
+	if (entry.Proxy == nullptr || (!usedThisFrame && !IsEntryValid(entry, sceneInfo, featureLevel)))
+	{
+		ReleaseEntry(entry);
+
+		entry.ComponentId = sceneInfo.PrimitiveComponentId;
+		entry.SceneInfo = &sceneInfo;
+		entry.Proxy = sceneInfo.Proxy;
+		entry.PrimitiveIndex = sceneInfo.GetIndex();
+		entry.InstanceSceneDataOffset = sceneInfo.GetInstanceSceneDataOffset();
+		for (int staticMeshIdx = 0; staticMeshIdx < sceneInfo.StaticMeshes.Num(); ++staticMeshIdx)
+		{
+			const auto& staticMesh = sceneInfo.StaticMeshes[staticMeshIdx];
+
+			const FMaterial* material = (staticMesh.MaterialRenderProxy == nullptr) ? nullptr :
+											&staticMesh.MaterialRenderProxy->GetIncompleteMaterialWithFallback(featureLevel);
+			entry.Materials.Emplace(material, (material == nullptr) ? nullptr : material->GetRenderingThreadShaderMap());
+
+			FCachingContext context(entry.Commands, staticMeshIdx);
+			buildCommands(&context, staticMesh, staticMeshIdx);
+		}
+
+		if (MergeInstances)
+			for (auto& cached : entry.Commands)
+				cached.StateBucketId = AcquireStateBucket(cached.Command);
+	}
+	entry.LastUsedFrame = GFrameCounterRenderThread;
+
+	//Add the visible ones to the view.
+	auto lods = GetStaticMeshLODs(viewInfo, sceneInfo);
+	for (const auto& cached : entry.Commands)
+	{
+		const auto& staticMesh = sceneInfo.StaticMeshes[cached.StaticMeshIdx];
+		//The visibility mask only has room for 64 elements; treat any past that as visible.
+		const uint64 elementBit = (cached.BatchElementIdx < 64) ? (1ull << cached.BatchElementIdx) : ~0ull;
+		if (!viewInfo.StaticMeshVisibilityMap[staticMesh.Id] ||
+			!lods.ContainsLOD(staticMesh.LODIndex) ||
+			(GetStaticMeshElementMask(viewInfo, staticMesh) & elementBit) == 0)
+		{
+			continue;
+		}
+
+		FVisibleMeshDrawCommand visibleCommand;
+		visibleCommand.Setup(&cached.Command, cached.IdInfo, cached.StateBucketId,
+							 cached.FillMode, cached.CullMode, cached.Flags, cached.SortKey,
+							 cached.CullingPayload, EMeshDrawCommandCullingPayloadFlags::Default);
+		output.Visible.Add(visibleCommand);
+	}
+}
+
+bool EGP::FCachedMeshDrawCommands::IsEntryValid(const FPrimitiveEntry& entry, const FPrimitiveSceneInfo& sceneInfo,
+												ERHIFeatureLevel::Type featureLevel)
+{
+	//A new scene proxy means the primitive was re-created (e.g. its Materials or mesh were changed).
+	//Moving around in the scene or GPU-scene changes the ID's baked into the commands.
+	if (entry.ComponentId != sceneInfo.PrimitiveComponentId ||
+		entry.SceneInfo != &sceneInfo ||
+		entry.Proxy != sceneInfo.Proxy ||
+		entry.PrimitiveIndex != sceneInfo.GetIndex() ||
+		entry.InstanceSceneDataOffset != sceneInfo.GetInstanceSceneDataOffset() ||
+		entry.Materials.Num() != sceneInfo.StaticMeshes.Num())
+	{
+		return false;
+	}
+
+	//Materials can finish compiling, or be recompiled, without the proxy changing.
+	for (int staticMeshIdx = 0; staticMeshIdx < sceneInfo.StaticMeshes.Num(); ++staticMeshIdx)
+	{
+		const auto* materialProxy = sceneInfo.StaticMeshes[staticMeshIdx].MaterialRenderProxy;
+		const FMaterial* material = (materialProxy == nullptr) ? nullptr :
+										&materialProxy->GetIncompleteMaterialWithFallback(featureLevel);
+		const auto& [cachedMaterial, cachedShaderMap] = entry.Materials[staticMeshIdx];
+		if (material != cachedMaterial ||
+			(material != nullptr && material->GetRenderingThreadShaderMap() != cachedShaderMap))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+void EGP::FCachedMeshDrawCommands::ReleaseEntry(FPrimitiveEntry& entry)
+{
+	for (const auto& cached : entry.Commands)
+	{
+		FGraphicsMinimalPipelineStateId::RemovePersistentId(cached.PipelineID);
+		if (cached.StateBucketId != INDEX_NONE)
+			ReleaseStateBucket(cached.StateBucketId);
+	}
+
+	entry.Commands.Reset();
+	entry.Materials.Reset();
+	entry.SceneInfo = nullptr;
+	entry.Proxy = nullptr;
+}
+
+int32 EGP::FCachedMeshDrawCommands::AcquireStateBucket(const FMeshDrawCommand& command)
+{
+	//Mirrors the engine's 'FStateBucketMap', which is keyed on the same hash and comparison.
+	FScopeLock lock(&stateBucketsLock);
+	const uint64 hash = command.GetDynamicInstancingHash();
+
+	TArray<int32, TInlineAllocator<4>> candidates;
+	stateBucketsByHash.MultiFind(hash, candidates);
+	for (int32 id : candidates)
+	{
+		auto& bucket = stateBuckets[id];
+		if (bucket.Command.MatchesForDynamicInstancing(command))
+		{
+			bucket.NumUsers += 1;
+			return id;
+		}
+	}
+
+	int32 id = stateBuckets.Add(FStateBucket{ command, 1 });
+	stateBucketsByHash.Add(hash, id);
+	return id;
+}
+void EGP::FCachedMeshDrawCommands::ReleaseStateBucket(int32 id)
+{
+	FScopeLock lock(&stateBucketsLock);
+	auto& bucket = stateBuckets[id];
+	if (--bucket.NumUsers > 0)
+		return;
+
+	stateBucketsByHash.RemoveSingle(bucket.Command.GetDynamicInstancingHash(), id);
+	stateBuckets.RemoveAt(id);
+}
+
+void EGP::FCachedMeshDrawCommands::Submit(const FViewInfo& viewInfo, FViewCommands& commands, FRHICommandList& cmds,
+										  bool forceStereoInstancingOff)
+{
+	//Mirrors the engine's 'DrawDynamicMeshPass()'.
+	//Sorting puts commands from the same state bucket next to each other, and merging turns them into instanced draws.
+	const uint32 instanceFactor = (!forceStereoInstancingOff && viewInfo.IsInstancedStereoPass()) ? 2 : 1;
+	FRHIBuffer* primitiveIdVertexBuffer = nullptr;
+	SortAndMergeDynamicPassMeshDrawCommands(viewInfo, cmds, commands.Visible, commands.DynamicStorage,
+											primitiveIdVertexBuffer, instanceFactor);
+	SubmitMeshDrawCommandsRange(commands.Visible, commands.PipelineStates, primitiveIdVertexBuffer,
+								FInstanceCullingContext::GetInstanceIdBufferStride(viewInfo.GetFeatureLevel()),
+								0, false, instanceFactor, 0, commands.Visible.Num(), cmds);
+}
+
+void EGP::FCachedMeshDrawCommands::Submit(const FViewInfo& viewInfo, TArrayView<FViewCommands* const> taskCommands,
+										  FRHICommandList& cmds, bool forceStereoInstancingOff)
+{
+	for (auto* commands : taskCommands)
+		if (commands != nullptr && commands->Visible.Num() > 0)
+			Submit(viewInfo, *commands, cmds, forceStereoInstancingOff);
+}
+
+void EGP::FCachedMeshDrawCommands::Tick()
+{
+	check(IsInRenderingThread());
+	const uint64 frame = GFrameCounterRenderThread;
+	for (auto it = entries.CreateIterator(); it; ++it)
+	{
+		if (frame - it->Value->LastUsedFrame > TimeoutFrames)
+		{
+			ReleaseEntry(*it->Value);
+			it.RemoveCurrent();
+		}
+	}
+}
+void EGP::FCachedMeshDrawCommands::Reset()
+{
+	for (auto& [persistentIdx, entry] : entries)
+		ReleaseEntry(*entry);
+	entries.Empty();
+}
@@ -0,0 +1,118 @@
+#include "EGP_HiZPass.h"
+
+#include "DataDrivenShaderPlatformInfo.h"
+#include "GlobalShader.h"
+#include "ShaderParameterStruct.h"
+#include "RenderGraphUtils.h"
+
+
+class FEGPBuildHiZCS : public FGlobalShader
+{
+public:
+	DECLARE_GLOBAL_SHADER(FEGPBuildHiZCS);
+	SHADER_USE_PARAMETER_STRUCT(FEGPBuildHiZCS, FGlobalShader);
+
+	static constexpr int32 MaxMips = 13;
+	//Each group reduces a 32x32 tile of mip 0.
+	static constexpr int32 TileSize = 32;
+
+	class FMode : SHADER_PERMUTATION_INT("HZB_MODE", 3);
+	using FPermutationDomain = TShaderPermutationDomain<FMode>;
+
+	BEGIN_SHADER_PARAMETER_STRUCT(FParameters, )
+		SHADER_PARAMETER_RDG_TEXTURE(Texture2D, DepthTexture)
+		SHADER_PARAMETER(FIntPoint, SrcRectMin)
+		SHADER_PARAMETER(FIntPoint, SrcRectMax)
+		SHADER_PARAMETER(FUintVector2, Mip0Size)
+		SHADER_PARAMETER(uint32, NumMips)
+		SHADER_PARAMETER(uint32, NumGroups)
+		SHADER_PARAMETER_RDG_BUFFER_UAV(RWBuffer<uint>, RWGroupCounter)
+		SHADER_PARAMETER_RDG_TEXTURE_UAV_ARRAY(RWTexture2D<float>, RWMips, [MaxMips])
+	END_SHADER_PARAMETER_STRUCT()
+
+	static bool ShouldCompilePermutation(const FGlobalShaderPermutationParameters& Parameters)
+	{
+		return IsFeatureLevelSupported(Parameters.Platform, ERHIFeatureLevel::SM5);
+	}
+};
+IMPLEMENT_GLOBAL_SHADER(FEGPBuildHiZCS, "/EGP/HiZ/build_hiz.usf", "BuildHiZCS", SF_Compute);
+
+
+EGP::FHiZPyramid EGP::AddHiZPass(FRDGBuilder& graph, ERHIFeatureLevel::Type featureLevel,
+								 FScreenPassTexture depth, EHiZMode mode)
+{
+	check(depth.IsValid());
+	const FIntRect srcRect = depth.ViewRect;
+
+	FHiZPyramid output;
+	output.Mode = mode;
+	output.Mip0Size = {
+		FMath::Max(1, static_cast<int32>(FMath::RoundUpToPowerOfTwo(srcRect.Width())) / 2),
+		FMath::Max(1, static_cast<int32>(FMath::RoundUpToPowerOfTwo(srcRect.Height())) / 2)
+	};
+	output.ViewportUVToHZBUV = {
+		static_cast<float>(srcRect.Width()) / static_cast<float>(2 * output.Mip0Size.X),
+		static_cast<float>(srcRect.Height()) / static_cast<float>(2 * output.Mip0Size.Y)
+	};
+
+	const int32 nMips = FMath::FloorLog2(FMath::Max(output.Mip0Size.X, output.Mip0Size.Y)) + 1;
+	checkf(nMips <= FEGPBuildHiZCS::MaxMips,
+		   TEXT("View is too big for a single-dispatch Hi-Z: %ix%i"), srcRect.Width(), srcRect.Height());
+
+	const EPixelFormat format = (mode == EHiZMode::MinAndMax) ? PF_G32R32F : PF_R32_FLOAT;
+	output.Texture = graph.CreateTexture(
+		FRDGTextureDesc::Create2D(output.Mip0Size, format, FClearValueBinding::None,
+								  TexCreate_ShaderResource | TexCreate_UAV, nMips),
+		TEXT("EGP.HiZ")
+	);
+
+	auto* params = graph.AllocParameters<FEGPBuildHiZCS::FParameters>();
+	params->DepthTexture = depth.Texture;
+	params->SrcRectMin = srcRect.Min;
+	params->SrcRectMax = srcRect.Max - FIntPoint(1, 1);
+	params->Mip0Size = FUintVector2(output.Mip0Size.X, output.Mip0Size.Y);
+	params->NumMips = static_cast<uint32>(nMips);
+
+	const FIntVector groupCount = FComputeShaderUtils::GetGroupCount(output.Mip0Size, FEGPBuildHiZCS::TileSize);
+	params->NumGroups = static_cast<uint32>(groupCount.X * groupCount.Y);
+
+	auto counter = graph.CreateBuffer(FRDGBufferDesc::CreateBufferDesc(sizeof(uint32), 1), TEXT("EGP.HiZGroupCounter"));
+	params->RWGroupCounter = graph.CreateUAV(counter, PF_R32_UINT);
+	AddClearUAVPass(graph, params->RWGroupCounter, 0u);
+
+	//Mip slots past the end of the pyramid still need something bound; the shader never writes to them.
+	FRDGTextureUAVRef unusedMipUAV = nullptr;
+	for (int32 mip = 0; mip < FEGPBuildHiZCS::MaxMips; ++mip)
+	{
+		if (mip < nMips)
+		{
+			params->RWMips[mip] = graph.CreateUAV(FRDGTextureUAVDesc(output.Texture, static_cast<uint8>(mip)));
+		}
+		else
+		{
+			if (unusedMipUAV == nullptr)
+			{
+				auto dummy = graph.CreateTexture(
+					FRDGTextureDesc::Create2D({ 1, 1 }, format, FClearValueBinding::None, TexCreate_UAV),
+					TEXT("EGP.HiZUnusedMip")
+				);
+				unusedMipUAV = graph.CreateUAV(dummy);
+			}
+			params->RWMips[mip] = unusedMipUAV;
+		}
+	}
+
+	FEGPBuildHiZCS::FPermutationDomain permutation;
+	permutation.Set<FEGPBuildHiZCS::FMode>(static_cast<int32>(mode));
+	TShaderMapRef<FEGPBuildHiZCS> shader(GetGlobalShaderMap(featureLevel), permutation);
+
+	FComputeShaderUtils::AddPass(
+		graph,
+		RDG_EVENT_NAME("EGP::BuildHiZ %ix%i -> %ix%i (%i mips)",
+					   srcRect.Width(), srcRect.Height(),
+					   output.Mip0Size.X, output.Mip0Size.Y, nMips),
+		shader, params, groupCount
+	);
+
+	return output;
+}
@@ -0,0 +1,38 @@
+#include "EGP_MaterialShaderSettings.h"
+
+
+namespace
+{
+	bool IsAllowedLocation(const FMaterialShaderParameters& material,
+						   const TArray<TEnumAsByte<EBlendableLocation>>& allowedLocations)
+	{
+		return allowedLocations.ContainsByPredicate([&](const TEnumAsByte<EBlendableLocation>& location)
+		{
+			return static_cast<int32>(location.GetValue()) == static_cast<int32>(material.BlendableLocation);
+		});
+	}
+}
+
+bool U_EGP_MaterialShaderSettings::ShouldCompileFor(const FMaterialShaderParameters& material, const TCHAR* shaderType) const
+{
+	//The engine's own Materials are used as fallbacks, so they always compile.
+	if (!FilterPermutations || material.bIsDefaultMaterial || material.bIsSpecialEngineMaterial)
+		return true;
+
+	if (shaderType != nullptr)
+		for (const auto& rule : ShaderTypeRules)
+			if (rule.ShaderType == shaderType)
+				return IsAllowedLocation(material, rule.BlendableLocations);
+
+	return IsAllowedLocation(material, DefaultBlendableLocations);
+}
+bool U_EGP_MaterialShaderSettings::ShouldAnyCompileFor(const FMaterialShaderParameters& material) const
+{
+	if (ShouldCompileFor(material, nullptr))
+		return true;
+
+	for (const auto& rule : ShaderTypeRules)
+		if (IsAllowedLocation(material, rule.BlendableLocations))
+			return true;
+	return false;
+}
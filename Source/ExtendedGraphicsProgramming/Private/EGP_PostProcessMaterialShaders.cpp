@@ -4,35 +4,166 @@
 #include "PostProcess/PostProcessMaterialInputs.h"
 #include "Runtime/Renderer/Private/SceneTextureParameters.h"
 #include "SystemTextures.h"
+#include "PipelineStateCache.h"
+#include "CommonRenderResources.h"
 
+#include "ExtendedGraphicsProgramming.h"
+#include "EGP_MaterialShaderSettings.h"
+
+
+DECLARE_GPU_STAT_NAMED(EGP_MaterialPasses, TEXT("EGP Material Passes"));
+
+bool EGP::impl::AddMaterialPassWithGPUStat(FRDGBuilder& renderGraph, TFunctionRef<bool()> addPass)
+{
+	RDG_GPU_STAT_SCOPE(renderGraph, EGP_MaterialPasses);
+	return addPass();
+}
+
+TOptional<EGP::FShaderMapFindResult> EGP::impl::FindMaterialPassShaders_RenderThread(const UMaterialInterface* material,
+																					   const FMaterialShaderTypes& shaderTypes,
+																					   ERHIFeatureLevel::Type featureLevel,
+																					   const FMissingShaderSettings& settings)
+{
+	auto found = FindMaterialShadersCached_RenderThread(material, shaderTypes, { MD_PostProcess, featureLevel });
+	if (found)
+		return found;
+
+	switch (settings.Policy)
+	{
+		case EMissingShaderPolicy::Crash:
+			checkf(false, TEXT("EGP Material pass has no shaders available for Material '%s'"),
+				   *GetNameSafe(material));
+			return NullOpt;
+
+		case EMissingShaderPolicy::Skip:
+			UE_LOG(LogEGP, Verbose,
+				   TEXT("Skipping a Material pass because Material '%s' doesn't have its shaders available"),
+				   *GetNameSafe(material));
+			return NullOpt;
+
+		case EMissingShaderPolicy::UseFallbackMaterial: {
+			const UMaterialInterface* fallback = settings.FallbackMaterial;
+			if (fallback == nullptr)
+				fallback = UMaterial::GetDefaultMaterial(MD_PostProcess);
+
+			found = FindMaterialShadersCached_RenderThread(fallback, shaderTypes, { MD_PostProcess, featureLevel });
+			if (!found)
+			{
+				UE_LOG(LogEGP, Verbose,
+					   TEXT("Skipping a Material pass because neither Material '%s' nor fallback '%s' have their shaders available"),
+					   *GetNameSafe(material), *GetNameSafe(fallback));
+			}
+			return found;
+		}
+
+		default: check(false); return NullOpt;
+	}
+}
+
+bool EGP::impl::PrecacheScreenSpacePipeline_RenderThread(FRHIVertexShader* shaderV, FRHIPixelShader* shaderP,
+														  const FScreenSpacePassRenderState& state,
+														  const FScreenSpacePassTargetFormats& targets)
+{
+	check(IsInRenderingThread());
+	if (!PipelineStateCache::IsPSOPrecachingEnabled())
+		return false;
+	if (targets.ColorFormats.Num() > MaxSimultaneousRenderTargets)
+	{
+		UE_LOG(LogEGP, Error, TEXT("Can't precache a screen-space pass with %i render targets (the max is %i)"),
+			   targets.ColorFormats.Num(), MaxSimultaneousRenderTargets);
+		return false;
+	}
+
+	//Mirror the pipeline that 'AddDrawScreenPass()' sets up, including its defaults for null states.
+	FGraphicsPipelineStateInitializer pso;
+	pso.BlendState = (state.BlendState != nullptr) ? state.BlendState :
+														FScreenPassPipelineState::FDefaultBlendState::GetRHI();
+	pso.RasterizerState = TStaticRasterizerState<>::GetRHI();
+	pso.DepthStencilState = (state.DepthStencilState != nullptr) ? state.DepthStencilState :
+																	  FScreenPassPipelineState::FDefaultDepthStencilState::GetRHI();
+	pso.BoundShaderState.VertexDeclarationRHI = GFilterVertexDeclaration.VertexDeclarationRHI;
+	pso.BoundShaderState.VertexShaderRHI = shaderV;
+	pso.BoundShaderState.PixelShaderRHI = shaderP;
+	pso.PrimitiveType = PT_TriangleList;
+
+	pso.RenderTargetsEnabled = targets.ColorFormats.Num();
+	for (int32 i = 0; i < targets.ColorFormats.Num(); ++i)
+	{
+		pso.RenderTargetFormats[i] = targets.ColorFormats[i];
+		pso.RenderTargetFlags[i] = targets.ColorFlags;
+	}
+	pso.DepthStencilTargetFormat = targets.DepthStencilFormat;
+	pso.DepthStencilTargetFlag = targets.DepthStencilFlags;
+	pso.NumSamples = targets.NumSamples;
+
+	pso.StatePrecachePSOHash = RHIComputeStatePrecachePSOHash(pso);
+	PipelineStateCache::PrecacheGraphicsPipelineState(pso);
+	return true;
+}
+
+namespace
+{
+	//Resources that every Material pass in a graph can share, stored in the graph's blackboard.
+	struct FSharedMaterialPassResources
+	{
+		FScreenPassTextureInput BlackDummyInput;
+		//Eye-adaptation SRV's, per view.
+		TArray<TPair<const FViewInfo*, FRDGBufferSRVRef>, TInlineAllocator<4>> EyeAdaptationSRVs;
+	};
+}
+RDG_REGISTER_BLACKBOARD_STRUCT(FSharedMaterialPassResources);
+
+namespace
+{
+	FSharedMaterialPassResources& GetSharedResources(FRDGBuilder& renderGraph)
+	{
+		if (auto* existing = renderGraph.Blackboard.GetMutable<FSharedMaterialPassResources>())
+			return *existing;
+
+		auto& resources = renderGraph.Blackboard.Create<FSharedMaterialPassResources>();
+		FScreenPassTexture blackDummyTex{ GSystemTextures.GetBlackDummy(renderGraph) };
+		renderGraph.RemoveUnusedTextureWarning(blackDummyTex.Texture);
+		resources.BlackDummyInput = GetScreenPassTextureInput(blackDummyTex,
+															  TStaticSamplerState<SF_Point, AM_Clamp, AM_Clamp, AM_Clamp>::GetRHI());
+		return resources;
+	}
+}
+
+void EGP::impl::SwitchToLoadActions(FRenderTargetBindingSlots& targets)
+{
+	targets.Enumerate([](FRenderTargetBinding& binding) { binding.SetLoadAction(ERenderTargetLoadAction::ELoad); });
+	if (targets.DepthStencil.GetTexture() != nullptr)
+	{
+		targets.DepthStencil = FDepthStencilBinding(targets.DepthStencil.GetTexture(),
+													ERenderTargetLoadAction::ELoad, ERenderTargetLoadAction::ELoad,
+													targets.DepthStencil.GetDepthStencilAccess());
+	}
+}
 
 void EGP::impl::FillSimulationMaterialParams(FRDGBuilder& renderGraph,
 											  FSimulationMaterialParameters* params,
-											  const FMaterial* material,
+											  uint32 usedPostProcessInputs,
 											  const FSimulationPassMaterialInputs& inputs)
 {
-	auto* samplerPointClamp = TStaticSamplerState<SF_Point, AM_Clamp, AM_Clamp, AM_Clamp>::GetRHI();
-	auto* samplerBilinearClamp = TStaticSamplerState<SF_Bilinear, AM_Clamp, AM_Clamp, AM_Clamp>::GetRHI();
-	params->PostProcessInput_BilinearSampler = samplerBilinearClamp;
-	
-	FScreenPassTexture blackDummyTex{ GSystemTextures.GetBlackDummy(renderGraph) };
-	renderGraph.RemoveUnusedTextureWarning(blackDummyTex.Texture);
+	params->PostProcessInput_BilinearSampler = TStaticSamplerState<SF_Bilinear, AM_Clamp, AM_Clamp, AM_Clamp>::GetRHI();
+
+	//Bind a dummy texture to any input that's missing or that the Material doesn't read.
+	const auto& blackDummyInput = GetSharedResources(renderGraph).BlackDummyInput;
 	for (int i = 0; i < kPostProcessMaterialInputCountMax; ++i)
 	{
-		if (!inputs.Textures[i].Texture || !material->GetRenderingThreadShaderMap()->UsesSceneTexture(PPI_PostProcessInput0 + i))
-			params->PostProcessInput[i] = GetScreenPassTextureInput(blackDummyTex, samplerPointClamp);
+		if (!inputs.Textures[i].Texture || (usedPostProcessInputs & (1u << i)) == 0)
+			params->PostProcessInput[i] = blackDummyInput;
 		else
 			params->PostProcessInput[i] = inputs.Textures[i];
 	}
 }
-
 void EGP::impl::FillScreenSpaceMaterialParams(FRDGBuilder& renderGraph,
 										       FScreenSpaceMaterialParameters* params,
-										       const FMaterial* material,
+										       uint32 usedPostProcessInputs,
 										       const FScreenSpacePassMaterialInputs& inputs)
 {
 	check(inputs.TargetView);
-	FillSimulationMaterialParams(renderGraph, &params->BaseParams, material,
+	FillSimulationMaterialParams(renderGraph, &params->BaseParams, usedPostProcessInputs,
 								 { inputs.Textures });
 	
 	if (inputs.SceneTextures)
@@ -42,7 +173,22 @@ void EGP::impl::FillScreenSpaceMaterialParams(FRDGBuilder& renderGraph,
 	
 	params->View = inputs.TargetView->ViewUniformBuffer;
 	params->PostProcessOutput = GetScreenPassTextureViewportParameters(inputs.OutputViewportData);
-	params->EyeAdaptationBuffer = renderGraph.CreateSRV(GetEyeAdaptationBuffer(renderGraph, *inputs.TargetView));
+	params->OutputCheckerboard = { inputs.OutputCheckerboardParity.IsSet() ? 1u : 0u,
+								   inputs.OutputCheckerboardParity.Get(0) & 1 };
+	params->RemapSvPositionToView = inputs.RemapSvPositionToView ? 1u : 0u;
+
+	//Only create one eye-adaptation SRV per view, per graph.
+	auto& eyeAdaptationSRVs = GetSharedResources(renderGraph).EyeAdaptationSRVs;
+	auto* existingSRV = eyeAdaptationSRVs.FindByPredicate([&](const auto& pair) { return pair.Key == inputs.TargetView; });
+	if (existingSRV != nullptr)
+	{
+		params->EyeAdaptationBuffer = existingSRV->Value;
+	}
+	else
+	{
+		params->EyeAdaptationBuffer = renderGraph.CreateSRV(GetEyeAdaptationBuffer(renderGraph, *inputs.TargetView));
+		eyeAdaptationSRVs.Emplace(inputs.TargetView, params->EyeAdaptationBuffer);
+	}
 }
 
 void EGP::FSimulationShader::ModifyCompilationEnvironment(const FMaterialShaderPermutationParameters& params,
@@ -60,17 +206,39 @@ void EGP::FScreenSpaceShader::ModifyCompilationEnvironment(const FMaterialShader
 	env.SetDefine(TEXT("EGP_POST_PASS"), 1);
 }
 
+namespace
+{
+	bool ShouldCompileMaterialPassPermutation(const FMaterialShaderPermutationParameters& params)
+	{
+		return FMaterialShader::ShouldCompilePermutation(params) &&
+			   (params.MaterialParameters.MaterialDomain == MD_PostProcess) &&
+			   (!IsMobilePlatform(params.Platform) || IsMobileHDR());
+	}
+}
 bool EGP::FSimulationShader::ShouldCompilePermutation(const FMaterialShaderPermutationParameters& params)
 {
-	return FMaterialShader::ShouldCompilePermutation(params) &&
-		   (params.MaterialParameters.MaterialDomain == MD_PostProcess) &&
-		   (!IsMobilePlatform(params.Platform) || IsMobileHDR());
+	return ShouldCompilePermutationFor(params, nullptr);
+}
+bool EGP::FSimulationShader::ShouldCompilePermutationFor(const FMaterialShaderPermutationParameters& params,
+														 const TCHAR* shaderType)
+{
+	return ShouldCompileMaterialPassPermutation(params) &&
+		   GetDefault<U_EGP_MaterialShaderSettings>()->ShouldCompileFor(params.MaterialParameters, shaderType);
 }
 bool EGP::FScreenSpaceShader::ShouldCompilePermutation(const FMaterialShaderPermutationParameters& params)
 {
-	return FMaterialShader::ShouldCompilePermutation(params) &&
-		   (params.MaterialParameters.MaterialDomain == MD_PostProcess) &&
-		   (!IsMobilePlatform(params.Platform) || IsMobileHDR());
+	return ShouldCompilePermutationFor(params, nullptr);
+}
+bool EGP::FScreenSpaceShader::ShouldCompilePermutationFor(const FMaterialShaderPermutationParameters& params,
+														  const TCHAR* shaderType)
+{
+	return ShouldCompileMaterialPassPermutation(params) &&
+		   GetDefault<U_EGP_MaterialShaderSettings>()->ShouldCompileFor(params.MaterialParameters, shaderType);
+}
+bool EGP::FScreenSpaceRenderVS::ShouldCompilePermutation(const FMaterialShaderPermutationParameters& params)
+{
+	return ShouldCompileMaterialPassPermutation(params) &&
+		   GetDefault<U_EGP_MaterialShaderSettings>()->ShouldAnyCompileFor(params.MaterialParameters);
 }
 
 void EGP::FSimulationShader::SetParameters(FRHIBatchedShaderParameters& paramBatch,
@@ -0,0 +1,136 @@
+#include "EGP_ReducedRatePass.h"
+
+#include "DataDrivenShaderPlatformInfo.h"
+#include "GlobalShader.h"
+#include "ShaderParameterStruct.h"
+#include "RenderGraphUtils.h"
+
+#include "EGP_DownsampleDepthPass.h"
+
+
+class FEGPReducedRateUpsamplePS : public FGlobalShader
+{
+public:
+	DECLARE_GLOBAL_SHADER(FEGPReducedRateUpsamplePS);
+	SHADER_USE_PARAMETER_STRUCT(FEGPReducedRateUpsamplePS, FGlobalShader);
+
+	class FCheckerboard : SHADER_PERMUTATION_BOOL("CHECKERBOARD");
+	using FPermutationDomain = TShaderPermutationDomain<FCheckerboard>;
+
+	BEGIN_SHADER_PARAMETER_STRUCT(FParameters, )
+		SHADER_PARAMETER_STRUCT_REF(FViewUniformShaderParameters, View)
+		SHADER_PARAMETER_RDG_TEXTURE(Texture2D, LowResTexture)
+		SHADER_PARAMETER_RDG_TEXTURE(Texture2D, LowResDepth)
+		SHADER_PARAMETER_RDG_TEXTURE(Texture2D, FullResDepth)
+		SHADER_PARAMETER(FIntPoint, LowResMin)
+		SHADER_PARAMETER(FIntPoint, LowResMax)
+		SHADER_PARAMETER(FIntPoint, FullResMin)
+		SHADER_PARAMETER(FIntPoint, FullResSize)
+		SHADER_PARAMETER(FIntPoint, OutputMin)
+		SHADER_PARAMETER(uint32, CheckerboardParity)
+		SHADER_PARAMETER(float, DepthSensitivity)
+		RENDER_TARGET_BINDING_SLOTS()
+	END_SHADER_PARAMETER_STRUCT()
+
+	static bool ShouldCompilePermutation(const FGlobalShaderPermutationParameters& Parameters)
+	{
+		return IsFeatureLevelSupported(Parameters.Platform, ERHIFeatureLevel::SM5);
+	}
+};
+IMPLEMENT_GLOBAL_SHADER(FEGPReducedRateUpsamplePS, "/EGP/ReducedRate/upsample.usf", "UpsamplePS", SF_Pixel);
+
+
+EGP::FReducedRateTarget EGP::CreateReducedRateTarget(FRDGBuilder& graph, const FViewInfo& view,
+													 FScreenPassTexture sceneDepth,
+													 EReducedRateMode mode, EPixelFormat format,
+													 const TCHAR* debugName)
+{
+	check(sceneDepth.IsValid());
+
+	FReducedRateTarget output;
+	output.Mode = mode;
+	output.FullResDepth = sceneDepth;
+
+	const FIntPoint fullSize = sceneDepth.ViewRect.Size();
+	const FIntPoint lowSize = (mode == EReducedRateMode::Half) ?
+								  FIntPoint::DivideAndRoundUp(fullSize, 2) :
+								  FIntPoint(FMath::DivideAndRoundUp(fullSize.X, 2), fullSize.Y);
+	const FIntRect lowRect(FIntPoint::ZeroValue, lowSize);
+
+	auto texture = graph.CreateTexture(
+		FRDGTextureDesc::Create2D(lowSize, format, FClearValueBinding::Black,
+								  TexCreate_ShaderResource | TexCreate_RenderTargetable | TexCreate_UAV),
+		debugName
+	);
+	output.LowRes = FScreenPassRenderTarget(texture, lowRect, ERenderTargetLoadAction::ENoAction);
+
+	if (mode == EReducedRateMode::Half)
+	{
+		//Point-sampling matches the depth that the Material itself sees at each low-res pixel.
+		auto depth = graph.CreateTexture(
+			FRDGTextureDesc::Create2D(lowSize, PF_DepthStencil, FClearValueBinding::DepthFar,
+									  TexCreate_ShaderResource | TexCreate_DepthStencilTargetable),
+			TEXT("EGP.ReducedRateDepth")
+		);
+		output.LowResDepth = FScreenPassTexture(depth, lowRect);
+		AddDownsampleDepthPass(graph, view, sceneDepth,
+							   FScreenPassRenderTarget(depth, lowRect, ERenderTargetLoadAction::ENoAction),
+							   EDownsampleDepthFilter::Point);
+	}
+	else
+	{
+		//Alternate the pattern every frame so that temporal AA fills in the gaps.
+		output.CheckerboardParity = view.Family->FrameNumber & 1;
+	}
+
+	return output;
+}
+
+void EGP::AddReducedRateUpsamplePass(FRDGBuilder& graph, const FViewInfo& view,
+									 const FReducedRateTarget& source,
+									 FScreenPassRenderTarget output,
+									 FRHIBlendState* blendState,
+									 float depthSensitivity)
+{
+	check(source.LowRes.IsValid() && source.FullResDepth.IsValid() && output.IsValid());
+	checkf(output.ViewRect.Size() == source.FullResDepth.ViewRect.Size(),
+		   TEXT("Upsample output is %ix%i, but the reduced-rate target approximates %ix%i"),
+		   output.ViewRect.Width(), output.ViewRect.Height(),
+		   source.FullResDepth.ViewRect.Width(), source.FullResDepth.ViewRect.Height());
+
+	const bool isCheckerboard = (source.Mode == EReducedRateMode::Checkerboard);
+	check(isCheckerboard || source.LowResDepth.IsValid());
+
+	auto* params = graph.AllocParameters<FEGPReducedRateUpsamplePS::FParameters>();
+	params->View = view.ViewUniformBuffer;
+	params->LowResTexture = source.LowRes.Texture;
+	//Checkerboarding doesn't downsample depth, so the full-res depth stands in.
+	params->LowResDepth = isCheckerboard ? source.FullResDepth.Texture : source.LowResDepth.Texture;
+	params->FullResDepth = source.FullResDepth.Texture;
+	params->LowResMin = source.LowRes.ViewRect.Min;
+	params->LowResMax = source.LowRes.ViewRect.Max - FIntPoint(1, 1);
+	params->FullResMin = source.FullResDepth.ViewRect.Min;
+	params->FullResSize = source.FullResDepth.ViewRect.Size();
+	params->OutputMin = output.ViewRect.Min;
+	params->CheckerboardParity = source.CheckerboardParity & 1;
+	params->DepthSensitivity = depthSensitivity;
+	params->RenderTargets[0] = output.GetRenderTargetBinding();
+
+	FEGPReducedRateUpsamplePS::FPermutationDomain permutation;
+	permutation.Set<FEGPReducedRateUpsamplePS::FCheckerboard>(isCheckerboard);
+	TShaderMapRef<FEGPReducedRateUpsamplePS> shaderP(view.ShaderMap, permutation);
+	TShaderMapRef<FScreenPassVS> shaderV(view.ShaderMap);
+
+	AddDrawScreenPass(
+		graph,
+		RDG_EVENT_NAME("EGP::ReducedRateUpsample(%s) %ix%i -> %ix%i",
+					   isCheckerboard ? TEXT("Checkerboard") : TEXT("Half"),
+					   source.LowRes.ViewRect.Width(), source.LowRes.ViewRect.Height(),
+					   output.ViewRect.Width(), output.ViewRect.Height()),
+		view,
+		FScreenPassTextureViewport(output), FScreenPassTextureViewport(source.LowRes),
+		shaderV, shaderP,
+		(blendState != nullptr) ? blendState : FScreenPassPipelineState::FDefaultBlendState::GetRHI(),
+		params
+	);
+}
@@ -0,0 +1,111 @@
+#include "EGP_SimulationState.h"
+
+#include "DataDrivenShaderPlatformInfo.h"
+#include "GlobalShader.h"
+#include "ShaderParameterStruct.h"
+
+
+class FEGPCompactSimulationTilesCS : public FGlobalShader
+{
+public:
+	DECLARE_GLOBAL_SHADER(FEGPCompactSimulationTilesCS);
+	SHADER_USE_PARAMETER_STRUCT(FEGPCompactSimulationTilesCS, FGlobalShader);
+
+	static constexpr uint32 GroupSize = 64;
+
+	BEGIN_SHADER_PARAMETER_STRUCT(FParameters, )
+		SHADER_PARAMETER_RDG_BUFFER_SRV(Buffer<uint>, TileActivity)
+		SHADER_PARAMETER(uint32, NumTiles)
+		SHADER_PARAMETER_RDG_BUFFER_UAV(RWBuffer<uint>, RWActiveTiles)
+		SHADER_PARAMETER_RDG_BUFFER_UAV(RWBuffer<uint>, RWActiveCount)
+	END_SHADER_PARAMETER_STRUCT()
+
+	static bool ShouldCompilePermutation(const FGlobalShaderPermutationParameters& Parameters)
+	{
+		return IsFeatureLevelSupported(Parameters.Platform, ERHIFeatureLevel::SM5);
+	}
+	static void ModifyCompilationEnvironment(const FGlobalShaderPermutationParameters& Parameters, FShaderCompilerEnvironment& OutEnvironment)
+	{
+		FGlobalShader::ModifyCompilationEnvironment(Parameters, OutEnvironment);
+		OutEnvironment.SetDefine(TEXT("COMPACT_TILES"), 1);
+		OutEnvironment.SetDefine(TEXT("GROUP_SIZE"), GroupSize);
+	}
+};
+IMPLEMENT_GLOBAL_SHADER(FEGPCompactSimulationTilesCS, "/EGP/Simulation/active_regions.usf", "CompactCS", SF_Compute);
+
+class FEGPBuildSimulationTileArgsCS : public FGlobalShader
+{
+public:
+	DECLARE_GLOBAL_SHADER(FEGPBuildSimulationTileArgsCS);
+	SHADER_USE_PARAMETER_STRUCT(FEGPBuildSimulationTileArgsCS, FGlobalShader);
+
+	BEGIN_SHADER_PARAMETER_STRUCT(FParameters, )
+		SHADER_PARAMETER_RDG_BUFFER_SRV(Buffer<uint>, ActiveCount)
+		SHADER_PARAMETER(uint32, GroupsPerTile)
+		SHADER_PARAMETER(uint32, GroupsPerRow)
+		SHADER_PARAMETER_RDG_BUFFER_UAV(RWBuffer<uint>, RWDispatchArgs)
+	END_SHADER_PARAMETER_STRUCT()
+
+	static bool ShouldCompilePermutation(const FGlobalShaderPermutationParameters& Parameters)
+	{
+		return IsFeatureLevelSupported(Parameters.Platform, ERHIFeatureLevel::SM5);
+	}
+	static void ModifyCompilationEnvironment(const FGlobalShaderPermutationParameters& Parameters, FShaderCompilerEnvironment& OutEnvironment)
+	{
+		FGlobalShader::ModifyCompilationEnvironment(Parameters, OutEnvironment);
+		OutEnvironment.SetDefine(TEXT("BUILD_ARGS"), 1);
+	}
+};
+IMPLEMENT_GLOBAL_SHADER(FEGPBuildSimulationTileArgsCS, "/EGP/Simulation/active_regions.usf", "BuildArgsCS", SF_Compute);
+
+
+EGP::FSimulationActiveRegions EGP::AddSimulationActiveRegionsPass(FRDGBuilder& graph, ERHIFeatureLevel::Type featureLevel,
+																  FRDGBufferRef tileActivity, uint32 nTiles,
+																  uint32 groupsPerTile, bool asyncCompute)
+{
+	check(tileActivity != nullptr);
+	check(groupsPerTile > 0);
+	RDG_EVENT_SCOPE(graph, "EGP::SimulationActiveRegions(%i tiles)", nTiles);
+
+	const ERDGPassFlags flags = asyncCompute ? ERDGPassFlags::AsyncCompute : ERDGPassFlags::Compute;
+	auto* shaderMap = GetGlobalShaderMap(featureLevel);
+
+	FSimulationActiveRegions output;
+	output.ActiveTiles = graph.CreateBuffer(FRDGBufferDesc::CreateBufferDesc(sizeof(uint32), FMath::Max(nTiles, 1u)),
+											TEXT("EGP.SimulationActiveTiles"));
+	output.ActiveCount = graph.CreateBuffer(FRDGBufferDesc::CreateBufferDesc(sizeof(uint32), 1),
+											TEXT("EGP.SimulationActiveTileCount"));
+	output.DispatchArgs = graph.CreateBuffer(FRDGBufferDesc::CreateIndirectDesc<FRHIDispatchIndirectParameters>(1),
+											 TEXT("EGP.SimulationActiveTileArgs"));
+
+	auto countUAV = graph.CreateUAV(output.ActiveCount, PF_R32_UINT);
+	AddClearUAVPass(graph, flags, countUAV, 0u);
+
+	//Compact.
+	{
+		auto* params = graph.AllocParameters<FEGPCompactSimulationTilesCS::FParameters>();
+		params->TileActivity = graph.CreateSRV(tileActivity, PF_R32_UINT);
+		params->NumTiles = nTiles;
+		params->RWActiveTiles = graph.CreateUAV(output.ActiveTiles, PF_R32_UINT);
+		params->RWActiveCount = countUAV;
+
+		TShaderMapRef<FEGPCompactSimulationTilesCS> shader(shaderMap);
+		FComputeShaderUtils::AddPass(graph, RDG_EVENT_NAME("CompactTiles"), flags, shader, params,
+									 FComputeShaderUtils::GetGroupCount(static_cast<int32>(nTiles),
+																		static_cast<int32>(FEGPCompactSimulationTilesCS::GroupSize)));
+	}
+
+	//Build indirect args.
+	{
+		auto* params = graph.AllocParameters<FEGPBuildSimulationTileArgsCS::FParameters>();
+		params->ActiveCount = graph.CreateSRV(output.ActiveCount, PF_R32_UINT);
+		params->GroupsPerTile = groupsPerTile;
+		params->GroupsPerRow = FSimulationActiveRegions::GroupsPerRow;
+		params->RWDispatchArgs = graph.CreateUAV(output.DispatchArgs, PF_R32_UINT);
+
+		TShaderMapRef<FEGPBuildSimulationTileArgsCS> shader(shaderMap);
+		FComputeShaderUtils::AddPass(graph, RDG_EVENT_NAME("BuildArgs"), flags, shader, params, FIntVector(1, 1, 1));
+	}
+
+	return output;
+}
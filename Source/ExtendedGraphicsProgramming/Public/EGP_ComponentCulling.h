@@ -0,0 +1,65 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+#include "EGP_CustomRenderPasses.h"
+#include "EGP_HiZPass.h"
+
+
+namespace EGP
+{
+	//The frustum (and optionally the depth pyramid) that 'AddComponentCullingPass()' tests against.
+	//It doesn't have to be the view's own frustum; e.g. a depth-only pass can cull from a light's point of view.
+	struct EXTENDEDGRAPHICSPROGRAMMING_API FComponentCullingView
+	{
+		FMatrix TranslatedWorldToClip = FMatrix::Identity;
+		FVector PreViewTranslation = FVector::ZeroVector;
+
+		//If set, components hidden behind this depth pyramid are also culled.
+		//It must be a "furthest" pyramid in device-Z (i.e. each texel is the minimum of the texels below it, like the engine's HZB).
+		FRDGTextureRef HZB = nullptr;
+		FIntPoint HZBMip0Size = { 0, 0 };
+		//Converts a UV in the view rect to a UV in the HZB texture.
+		FVector2f ViewportUVToHZBUV = { 1, 1 };
+
+		//Culls against the view's frustum, and optionally its HZB if the renderer has built one this frame.
+		static FComponentCullingView FromView(const FViewInfo& view, bool useViewHZB = true);
+		//Occlusion-culls against a pyramid from 'AddHiZPass()', which must use 'EHiZMode::Min'.
+		void SetHZB(const FHiZPyramid& pyramid);
+	};
+
+	//Describes the instanced draw that the culling pass writes indirect args for.
+	//The instance count is filled in on the GPU.
+	struct FComponentCullingDrawArgs
+	{
+		uint32 IndexCountPerInstance = 0,
+			   StartIndexLocation = 0;
+		int32 BaseVertexLocation = 0;
+	};
+
+	struct FComponentCullingResult
+	{
+		//The slot of each visible component, packed together in no particular order (a 'Buffer<uint>').
+		FRDGBufferRef VisibleSlots = nullptr;
+		//The number of visible components (a 'Buffer<uint>' with one element).
+		FRDGBufferRef VisibleCount = nullptr;
+
+		//Indirect args for an instanced, indexed draw with one instance per visible component.
+		FRDGBufferRef DrawArgs = nullptr;
+		//Indirect args for a compute dispatch with one thread per visible component,
+		//    usable directly as the group count of an 'FSimulationPassState'.
+		FRDGBufferRef DispatchArgs = nullptr;
+	};
+
+	//Culls a custom pass's components on the GPU, using the bounds in its GPU proxy mirror
+	//    (see 'U_EGP_RenderPass::GetProxyBuffer_RenderThread()').
+	//Outputs the visible components' slots plus indirect args for drawing or processing them.
+	EXTENDEDGRAPHICSPROGRAMMING_API FComponentCullingResult AddComponentCullingPass(
+		FRDGBuilder& graph, ERHIFeatureLevel::Type featureLevel,
+		const CustomRenderPasses::FProxyGPUBuffer& components,
+		const FComponentCullingView& view,
+		const FComponentCullingDrawArgs& drawArgs = { },
+		uint32 dispatchGroupSize = 64,
+		bool asyncCompute = false
+	);
+}
@@ -1,6 +1,8 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "Containers/Queue.h"
+#include "Async/ParallelFor.h"
 #include "SceneViewExtension.h"
 #include "Runtime/Renderer/Private/SceneRendering.h"
 
@@ -21,10 +23,15 @@ namespace EGP
 {
 	//A whitelist OR blacklist of some objects.
 	//You can pick which on construction, or after adding your first object.
+	//
+	//With the default comparator, elements are stored in a hash set (so 'T' needs a 'GetTypeHash()').
+	//Custom comparators fall back to a linear search.
 	template<typename T, typename CompareFn = std::equal_to<T>>
 	class FilterList
 	{
 	public:
+		static constexpr bool IsHashed = std::is_same_v<CompareFn, std::equal_to<T>>;
+
 		FilterList(TOptional<bool> _isWhitelist = NullOpt)
 			: isWhitelist(_isWhitelist) { }
 		FilterList(CompareFn comparator, TOptional<bool> _isWhitelist = NullOpt)
@@ -37,7 +44,11 @@ namespace EGP
 				return true;
 
 			bool isListed = false;
-			for (const T& element : elements)
+			if constexpr (IsHashed)
+			{
+				isListed = elements.Contains(t);
+			}
+			else for (const T& element : elements)
 			{
 				if (Comparator(element, t))
 				{
@@ -57,36 +68,48 @@ namespace EGP
 			check(isWhitelist != true);
 			isWhitelist = false;
 			elements.Add(t);
+			version += 1;
 		}
 		void AddWhitelisted(const T& t)
 		{
 			check(isWhitelist != false);
 			isWhitelist = true;
 			elements.Add(t);
+			version += 1;
 		}
 		void Remove(const T& t)
 		{
-			elements.RemoveAll([&](const T& t2)
+			if constexpr (IsHashed)
+			{
+				elements.Remove(t);
+			}
+			else elements.RemoveAll([&](const T& t2)
 			{
 				return Comparator(t, t2);
 			});
+			version += 1;
 		}
 
 		//Updates this filter to be a blacklist or whitelist, without changing its elements.
-		void Configure(bool _isWhitelist) { isWhitelist = _isWhitelist; }
+		void Configure(bool _isWhitelist) { isWhitelist = _isWhitelist; version += 1; }
 		
 		void Clear(TOptional<bool> isNowWhitelist = NullOpt)
 		{
 			elements.Empty();
 			isWhitelist = isNowWhitelist;
+			version += 1;
 		}
 
 		size_t GetSize() const { return elements.Num(); }
 
+		//Incremented every time this list changes, so callers can cache the results of testing against it.
+		uint32 GetVersion() const { return version; }
+
 		CompareFn Comparator;
 	private:
 		TOptional<bool> isWhitelist;
-		TArray<T> elements;
+		std::conditional_t<IsHashed, TSet<T>, TArray<T>> elements;
+		uint32 version = 0;
 	};
 }
 
@@ -112,7 +135,7 @@ public:
 	//The actors that get tested against this filter are usually PlayerControllers
 	//    or the target of their PlayerCameraManager if that exists.
 	UFUNCTION(BlueprintCallable, Category="Viewport Filtering|Actor")
-	void FilterByActor(const AActor* actor, bool isWhitelist = true) { UpdateFilterList(byViewActor_GT, byViewActor_RT, { actor }, true, isWhitelist); }
+	void FilterByActor(const AActor* actor, bool isWhitelist = true) { UpdateFilterList(byViewActor_GT, { actor }, true, isWhitelist); }
 	//Removes the given viewport actor from the filter list
 	//    (enabling it if using a blacklist, or disabling it if using a whitelist).
 	//
@@ -121,75 +144,75 @@ public:
 	//The actors that get tested against this filter are usually PlayerControllers
 	//    or the target of their PlayerCameraManager if that exists.
 	UFUNCTION(BlueprintCallable, Category="Viewport Filtering|Actor")
-	void RemoveByActor(const AActor* actor) { UpdateFilterList(byViewActor_GT, byViewActor_RT, { actor }, false, false); }
+	void RemoveByActor(const AActor* actor) { UpdateFilterList(byViewActor_GT, { actor }, false, false); }
 	//Sets the actor filter to be a blacklist or whitelist.
 	//
 	//This can also be done automatically when adding the first element to the filter.
 	UFUNCTION(BlueprintCallable, Category="Viewport Filtering|Actor")
-	void ConfigureByActor(bool isWhitelist) { ConfigureFilterList(byViewActor_GT, byViewActor_RT, isWhitelist); }
+	void ConfigureByActor(bool isWhitelist) { ConfigureFilterList(byViewActor_GT, isWhitelist); }
 	//Clears all filtering by viewport actor, including the question of whether it's a whitelist or blacklist.
 	UFUNCTION(BlueprintCallable, Category="Viewport Filtering|Actor")
-	void ClearsByActor() { ClearFilterList(byViewActor_GT, byViewActor_RT); }
+	void ClearsByActor() { ClearFilterList(byViewActor_GT); }
 
 	//Adds the given player controller index to a whitelist or blacklist.
 	//Note that you can't do both whitelisting *and* blacklisting!
 	UFUNCTION(BlueprintCallable, Category="Viewport Filtering|Player Index")
-	void FilterByPlayerIdx(int playerIdx, bool isWhitelist = true) { UpdateFilterList(byPlayerIndex_GT, byPlayerIndex_RT, playerIdx, true, isWhitelist); }
+	void FilterByPlayerIdx(int playerIdx, bool isWhitelist = true) { UpdateFilterList(byPlayerIndex_GT, playerIdx, true, isWhitelist); }
 	//Removes the given player controller index from the filter list
 	//    (enabling it if using a blacklist, or disabling it if using a whitelist).
 	//
 	//Does nothing if the index isn't in the list.
 	UFUNCTION(BlueprintCallable, Category="Viewport Filtering|Player Index")
-	void RemoveByPlayerIdx(int playerIdx) { UpdateFilterList(byPlayerIndex_GT, byPlayerIndex_RT, playerIdx, false, false); }
+	void RemoveByPlayerIdx(int playerIdx) { UpdateFilterList(byPlayerIndex_GT, playerIdx, false, false); }
 	//Sets the player-index filter to be a blacklist or whitelist.
 	//
 	//This can also be done automatically when adding the first element to the filter.
 	//This can't be done after an element has been added.
 	UFUNCTION(BlueprintCallable, Category="Viewport Filtering|Player Index")
-	void ConfigureByPlayerIdx(bool isWhitelist) { ConfigureFilterList(byPlayerIndex_GT, byPlayerIndex_RT, isWhitelist); }
+	void ConfigureByPlayerIdx(bool isWhitelist) { ConfigureFilterList(byPlayerIndex_GT, isWhitelist); }
 	//Clears all filtering by player index, including the question of whether it's a whitelist or blacklist.
 	UFUNCTION(BlueprintCallable, Category="Viewport Filtering|Player Index")
-	void ClearsByPlayerIdx() { ClearFilterList(byPlayerIndex_GT, byPlayerIndex_RT); }
+	void ClearsByPlayerIdx() { ClearFilterList(byPlayerIndex_GT); }
 
 	//Adds the given viewport to a whitelist or blacklist.
 	//Note that you can't do both whitelisting *and* blacklisting!
-	void FilterByViewport(const FViewport* viewport, bool isWhitelist = true) { UpdateFilterList(byViewport_GT, byViewport_RT, viewport, true, isWhitelist); }
+	void FilterByViewport(const FViewport* viewport, bool isWhitelist = true) { UpdateFilterList(byViewport_GT, viewport, true, isWhitelist); }
 	//Removes the give viewport from the filter list
 	//    (enabling it if using a blacklist, or disabling it if using a whitelist).
 	//
 	//Does nothing if the index isn't in the list.
-	void RemoveByViewport(const FViewport* viewport) { UpdateFilterList(byViewport_GT, byViewport_RT, viewport, false, false); }
+	void RemoveByViewport(const FViewport* viewport) { UpdateFilterList(byViewport_GT, viewport, false, false); }
 	//Sets the viewport filter to be a blacklist or whitelist.
 	//
 	//This can also be done automatically when adding the first element to the filter.
 	//This can't be done after an element has been added.
 	UFUNCTION(BlueprintCallable, Category="Viewport Filtering|Viewport")
-	void ConfigureByViewport(bool isWhitelist) { ConfigureFilterList(byViewport_GT, byViewport_RT, isWhitelist); }
+	void ConfigureByViewport(bool isWhitelist) { ConfigureFilterList(byViewport_GT, isWhitelist); }
 	//Clears all filtering by viewport reference, including the question of whether it's a whitelist or blacklist.
 	UFUNCTION(BlueprintCallable, Category="Viewport Filtering|Viewport")
-	void ClearsByViewport() { ClearFilterList(byViewport_GT, byViewport_RT); }
+	void ClearsByViewport() { ClearFilterList(byViewport_GT); }
 
 	//Adds the given scene to a whitelist or blacklist.
 	//Note that you can't do both whitelisting *and* blacklisting!
-	void FilterByScene(const FSceneInterface* scene, bool isWhitelist = true) { UpdateFilterList(byScene_GT, byScene_RT, scene, true, isWhitelist); }
+	void FilterByScene(const FSceneInterface* scene, bool isWhitelist = true) { UpdateFilterList(byScene_GT, scene, true, isWhitelist); }
 	//Removes the given scene from the filter list
 	//    (enabling it if using a blacklist, or disabling it if using a whitelist).
 	//
 	//Does nothing if the index isn't in the list.
-	void RemoveByScene(const FSceneInterface* scene) { UpdateFilterList(byScene_GT, byScene_RT, scene, false, false); }
+	void RemoveByScene(const FSceneInterface* scene) { UpdateFilterList(byScene_GT, scene, false, false); }
 	//Sets the viewport filter to be a blacklist or whitelist.
 	//
 	//This can also be done automatically when adding the first element to the filter.
 	//This can't be done after an element has been added.
 	UFUNCTION(BlueprintCallable, Category="Viewport Filtering|Viewport")
-	void ConfigureByScene(bool isWhitelist) { ConfigureFilterList(byScene_GT, byScene_RT, isWhitelist); }
+	void ConfigureByScene(bool isWhitelist) { ConfigureFilterList(byScene_GT, isWhitelist); }
 	//Clears all filtering by scene reference, including the question of whether it's a whitelist or blacklist.
 	UFUNCTION(BlueprintCallable, Category="Viewport Filtering|Viewport")
-	void ClearsByScene() { ClearFilterList(byScene_GT, byScene_RT); }
+	void ClearsByScene() { ClearFilterList(byScene_GT); }
 
 	//Adds the given render-target to a whitelist or blacklist.
 	//Note that you can't do both whitelisting *and* blacklisting!
-	void FilterByRenderTarget(const FRenderTarget* rt, bool isWhitelist = true) { UpdateFilterList(byRenderTarget_GT, byRenderTarget_RT, rt, true, isWhitelist); }
+	void FilterByRenderTarget(const FRenderTarget* rt, bool isWhitelist = true) { UpdateFilterList(byRenderTarget_GT, rt, true, isWhitelist); }
 	//Adds the given render-target to a whitelist or blacklist.
 	//Note that you can't do both whitelisting *and* blacklisting!
 	//
@@ -200,7 +223,7 @@ public:
 	//    (enabling it if using a blacklist, or disabling it if using a whitelist).
 	//
 	//Does nothing if the index isn't in the list.
-	void RemoveByRenderTarget(const FRenderTarget* rt) { UpdateFilterList(byRenderTarget_GT, byRenderTarget_RT, rt, false, false); }
+	void RemoveByRenderTarget(const FRenderTarget* rt) { UpdateFilterList(byRenderTarget_GT, rt, false, false); }
 	//Removes the given scene from the filter list
 	//    (enabling it if using a blacklist, or disabling it if using a whitelist).
 	//
@@ -212,10 +235,10 @@ public:
 	//This can also be done automatically when adding the first element to the filter.
 	//This can't be done after an element has been added.
 	UFUNCTION(BlueprintCallable, Category="Viewport Filtering|Render-Target")
-	void ConfigureByRenderTarget(bool isWhitelist) { ConfigureFilterList(byRenderTarget_GT, byRenderTarget_RT, isWhitelist); }
+	void ConfigureByRenderTarget(bool isWhitelist) { ConfigureFilterList(byRenderTarget_GT, isWhitelist); }
 	//Clears all filtering by render-target, including the question of whether it's a whitelist or blacklist.
 	UFUNCTION(BlueprintCallable, Category="Viewport Filtering|Render-Target")
-	void ClearsByRenderTarget() { ClearFilterList(byRenderTarget_GT, byRenderTarget_RT); }
+	void ClearsByRenderTarget() { ClearFilterList(byRenderTarget_GT); }
 
 	
 	bool ShouldRenderFor(const FViewport* viewport) const;
@@ -223,115 +246,115 @@ public:
 	bool ShouldRenderFor(const FSceneViewExtensionContext& sveContext) const;
 	bool ShouldRenderFor(const FSceneViewFamily& viewFamily) const;
 	bool ShouldRenderFor(const FSceneView& view) const;
+
+	//Filter changes are made immediately on the game thread,
+	//    but only reach the render thread the next time this is called.
+	//The subsystem calls this every frame for each pass (even throttled ones),
+	//    so you only need it if the render thread must see changes sooner.
+	//
+	//Sends all filters in one render command, so it's cheap to make many changes in a row.
+	UFUNCTION(BlueprintCallable, Category="Viewport Filtering")
+	void SyncToRenderThread();
 	
 protected:
 
 	//Keep a game-thread and render-thread copy of each filter.
 	//This is needed because sometimes decisions (like SVE applicability) are made on the game-thread,
 	//    but most render stuff is done on the render-thread.
-	EGP::FilterList<const FRenderTarget*> byRenderTarget_GT, byRenderTarget_RT;
-	EGP::FilterList<const FSceneInterface*> byScene_GT, byScene_RT;
-	EGP::FilterList<const FViewport*> byViewport_GT, byViewport_RT;
-	EGP::FilterList<TWeakObjectPtr<const AActor>> byViewActor_GT, byViewActor_RT;
-	EGP::FilterList<int> byPlayerIndex_GT, byPlayerIndex_RT;
+	//
+	//The game thread edits its copies directly, then the render thread receives all of them at once
+	//    as an immutable snapshot (see 'SyncToRenderThread()'), so it never sees a half-finished update.
+	EGP::FilterList<const FRenderTarget*> byRenderTarget_GT;
+	EGP::FilterList<const FSceneInterface*> byScene_GT;
+	EGP::FilterList<const FViewport*> byViewport_GT;
+	EGP::FilterList<TWeakObjectPtr<const AActor>> byViewActor_GT;
+	EGP::FilterList<int> byPlayerIndex_GT;
+	struct FSnapshot
+	{
+		EGP::FilterList<const FRenderTarget*> byRenderTarget;
+		EGP::FilterList<const FSceneInterface*> byScene;
+		EGP::FilterList<const FViewport*> byViewport;
+		EGP::FilterList<TWeakObjectPtr<const AActor>> byViewActor;
+		EGP::FilterList<int> byPlayerIndex;
+	};
+	TSharedRef<const FSnapshot, ESPMode::ThreadSafe> snapshot_RT = MakeShared<const FSnapshot, ESPMode::ThreadSafe>();
+	//Whether the game-thread filters changed since the last snapshot.
+	bool isDirty_GT = false;
+
+	//The view-family test runs for every view, and again for the SVE, so its verdict is cached per frame.
+	//It's keyed on the family's scene and render target rather than the family itself,
+	//    because families are short-lived and their addresses get reused.
+	//The cache is thrown out when the frame changes or when any of the relevant filters change.
+	struct FFamilyVerdictCache
+	{
+		uint32 FrameNumber = 0,
+			   FilterVersion = 0;
+		TMap<TPair<const FSceneInterface*, const FRenderTarget*>, bool> Verdicts;
+	};
+	mutable FFamilyVerdictCache familyVerdicts_GT, familyVerdicts_RT;
 
-	//Modifies the given filter list.
+	//Modifies the given (game-thread) filter list.
 	//Callable from anywhere.
 	template<typename T>
-	void UpdateFilterList(EGP::FilterList<T>& _filter_GT, EGP::FilterList<T>& _filter_RT,
-						  T element, bool isAdding, bool isAddingAsWhitelist)
+	void UpdateFilterList(EGP::FilterList<T>& filter, T element, bool isAdding, bool isAddingAsWhitelist)
 	{
-		//References captured by copy do actually copy the object, so we need pointers. 
-		auto* filterGT = &_filter_GT;
-		auto* filterRT = &_filter_RT;
-
-		auto updateFilter = [element, isAdding, isAddingAsWhitelist](EGP::FilterList<T>& filter)
+		EditFilterList(filter, [element, isAdding, isAddingAsWhitelist](EGP::FilterList<T>& f)
 		{
 			//You can't add a whitelisted object to a blacklist, and vice versa.
-			if (isAdding && filter.IsAWhitelist().IsSet() && filter.IsAWhitelist() != isAddingAsWhitelist)
+			if (isAdding && f.IsAWhitelist().IsSet() && f.IsAWhitelist() != isAddingAsWhitelist)
 			{
 				UE_LOG(LogEGP, Error,
 					   TEXT("Tried to add a %s element to a %s view-filter! The operation failed."),
 					   isAddingAsWhitelist ? TEXT("whitelisted") : TEXT("blacklisted"),
-					   filter.IsAWhitelist() ? TEXT("whitelist") :  TEXT("blacklist")
+					   f.IsAWhitelist() ? TEXT("whitelist") :  TEXT("blacklist")
 				);
 				return;
 			}
 			
 			if (isAdding)
 				if (isAddingAsWhitelist)
-					filter.AddWhitelisted(element);
+					f.AddWhitelisted(element);
 				else
-					filter.AddBlacklisted(element);
+					f.AddBlacklisted(element);
 				else
-					filter.Remove(element);
-		};
-		
-		ENQUEUE_RENDER_COMMAND(UpdateFilter)([filterRT, updateFilter](FRHICommandListImmediate&)
-		{
-			updateFilter(*filterRT);
-		});
-		
-		if (IsInGameThread())
-		{
-			updateFilter(*filterGT);
-		}
-		else AsyncTask(ENamedThreads::GameThread, [filterGT, updateFilter]()
-		{
-			updateFilter(*filterGT);
+					f.Remove(element);
 		});
 	}
 	
-	//Clears the given filter list.
+	//Clears the given (game-thread) filter list.
 	//Callable from anywhere.
 	template<typename T>
-	void ClearFilterList(EGP::FilterList<T>& _filter_GT, EGP::FilterList<T>& _filter_RT)
+	void ClearFilterList(EGP::FilterList<T>& filter)
 	{
-		//References captured by copy do actually copy the object, so we need pointers. 
-		auto* filterGT = &_filter_GT;
-		auto* filterRT = &_filter_RT;
-
-		auto updateFilter = [](EGP::FilterList<T>& filter) { filter.Clear(); };
-
-		ENQUEUE_RENDER_COMMAND(ClearFilter)([filterRT, updateFilter](FRHICommandListImmediate&)
-		{
-			updateFilter(*filterRT);
-		});
-
-		if (IsInGameThread())
-		{
-			updateFilter(*filterGT);
-		}
-		else AsyncTask(ENamedThreads::GameThread, [filterGT, updateFilter]()
-		{
-			updateFilter(*filterGT);
-		});
+		EditFilterList(filter, [](EGP::FilterList<T>& f) { f.Clear(); });
 	}
 	
-	//Configures the given filter list.
+	//Configures the given (game-thread) filter list.
 	//Callable from anywhere.
 	template<typename T>
-	void ConfigureFilterList(EGP::FilterList<T>& _filter_GT, EGP::FilterList<T>& _filter_RT,
-				   		     bool makeWhitelist)
+	void ConfigureFilterList(EGP::FilterList<T>& filter, bool makeWhitelist)
 	{
-		//References captured by copy do actually copy the object, so we need pointers. 
-		auto* filterGT = &_filter_GT;
-		auto* filterRT = &_filter_RT;
-
-		auto updateFilter = [makeWhitelist](EGP::FilterList<T>& filter) { filter.Configure(makeWhitelist); };
+		EditFilterList(filter, [makeWhitelist](EGP::FilterList<T>& f) { f.Configure(makeWhitelist); });
+	}
 
-		ENQUEUE_RENDER_COMMAND(ClearFilter)([filterRT, updateFilter](FRHICommandListImmediate&)
-		{
-			updateFilter(*filterRT);
-		});
+	//Runs the given edit on a game-thread filter list, and marks the filters as needing to be re-sent.
+	//If called off the game thread, the edit is deferred to the game thread.
+	template<typename T, typename Lambda>
+	void EditFilterList(EGP::FilterList<T>& _filter, Lambda updateFilter)
+	{
+		//References captured by copy do actually copy the object, so we need pointers. 
+		auto* filter = &_filter;
+		auto* _this = this;
 
 		if (IsInGameThread())
 		{
-			updateFilter(*filterGT);
+			updateFilter(*filter);
+			isDirty_GT = true;
 		}
-		else AsyncTask(ENamedThreads::GameThread, [filterGT, updateFilter]()
+		else AsyncTask(ENamedThreads::GameThread, [_this, filter, updateFilter]()
 		{
-			updateFilter(*filterGT);
+			updateFilter(*filter);
+			_this->isDirty_GT = true;
 		});
 	}
 };
@@ -342,27 +365,131 @@ protected:
 
 namespace EGP { namespace CustomRenderPasses
 {
-	//We don't know what kind of proxy data each render pass uses, and templates don't play well with Unreal,
-	//    so we allocate a constant number of bytes per proxy
-	//    and let the user worry about pooling heap memory if they truly need more than that.
+	//Templates don't play well with Unreal, so proxies are handled as raw bytes.
+	//Each component type reports the size of its proxy struct (see 'EGP_PASS_COMPONENT_SIMPLE_PROXY_IMPL'),
+	//    and proxies are always placed at this alignment.
+	static constexpr int32 ProxyAlignment = 16;
+
+	//All the proxy changes for one pass over one frame, handed to the render thread in a single command.
+	//Acts as a linear arena: the pass recycles its batches between frames, so their memory is reused.
+	struct FProxyUpdateBatch
+	{
+		struct FEntry
+		{
+			//The component's slot in its pass's FProxyStorage.
+			int32 Slot = INDEX_NONE;
+			TWeakObjectPtr<UPrimitiveComponent> Target;
+			//The range of 'Bytes' holding this component's new proxy.
+			int32 ByteOffset = 0,
+				  ByteCount = 0;
+		};
+		TArray<FEntry> Entries;
+
+		//The proxy data of every entry, packed contiguously.
+		TArray<std::byte> Bytes;
+
+		//Allocates space for a new proxy at the end of the arena, returning its byte offset.
+		int32 Allocate(int32 nBytes)
+		{
+			int32 offset = Align(Bytes.Num(), ProxyAlignment);
+			Bytes.SetNumUninitialized(offset + nBytes, false);
+			return offset;
+		}
+		//Clears the batch without releasing its memory.
+		void Reset()
+		{
+			Entries.Reset();
+			Bytes.Reset();
+		}
+	};
+
+	//The render-thread copy of a pass's components and their proxies, packed densely for fast iteration.
+	//Each component is given a stable slot when it registers.
+	//Slots map into dense arrays, which stay contiguous by swapping the last element into any hole.
+	class EXTENDEDGRAPHICSPROGRAMMING_API FProxyStorage
+	{
+	public:
+
+		struct FElement
+		{
+			const U_EGP_RenderPassComponent* Component = nullptr;
+			TWeakObjectPtr<UPrimitiveComponent> Target;
+			//False until the component's first proxy arrives from the game thread.
+			bool HasProxy = false;
+		};
+
+		int32 Num() const { return elements.Num(); }
+		const FElement& GetElement(int32 denseIdx) const { return elements[denseIdx]; }
+		const std::byte* GetProxy(int32 denseIdx) const { return proxyBytes.GetData() + (denseIdx * proxyStride); }
+		std::byte* GetProxy(int32 denseIdx) { return proxyBytes.GetData() + (denseIdx * proxyStride); }
+
+		//Returns INDEX_NONE if the slot isn't in use.
+		int32 GetDenseIndex(int32 slot) const { return slotToDense.IsValidIndex(slot) ? slotToDense[slot] : INDEX_NONE; }
+		int32 GetSlot(int32 denseIdx) const { return denseToSlot[denseIdx]; }
+		//One more than the highest slot ever used.
+		int32 NumSlots() const { return slotToDense.Num(); }
+		int32 GetProxyStride() const { return proxyStride; }
+
+		void Add(int32 slot, const U_EGP_RenderPassComponent* component, int32 nProxyBytes);
+		void Remove(int32 slot);
+		void Write(int32 slot, const TWeakObjectPtr<UPrimitiveComponent>& target,
+				   const std::byte* proxy, int32 nProxyBytes);
+
+	private:
+
+		TArray<FElement> elements;
+		TArray<int32> denseToSlot, slotToDense;
+
+		//Proxies are stored back-to-back, each one taking up 'proxyStride' bytes.
+		TArray<std::byte> proxyBytes;
+		int32 proxyStride = 0;
+
+		void SetStride(int32 newStride);
+	};
+
+	//The GPU mirror of a pass's proxy storage, registered with one render graph.
+	//It's a ByteAddressBuffer indexed by slot: each component's proxy starts at byte 'slot * Stride'.
+	//Slots that aren't in use (or haven't received a proxy yet) contain garbage.
 	//
-	//You can also `#define EGP_CUSTOMRENDERPASS_MAXPROXYBYTESIZE 1024` or whatever size you want,
-	//    but this forces all custom passes in the project to use the same size.
-	static constexpr uint32 MaxInlineProxyByteSize =
-		#if defined(EGP_CUSTOMRENDERPASS_MAXPROXYBYTESIZE)
-			EGP_CUSTOMRENDERPASS_MAXPROXYBYTESIZE
-		#else
-			512
-		#endif
-	;
-
-	//A byte array holding a render proxy, which can stay on the stack as long as it is less than N bytes.
-	//Otherwise it will be moved to the heap.
-	using ProxyData_t = TArray<std::byte, TInlineAllocator<MaxInlineProxyByteSize>>;
+	//'PrimitiveSlots' is a second ByteAddressBuffer, mapping each primitive's GPU-Scene ID to its component's slot
+	//    (the slot for primitive ID 'p' is the uint at byte 'p * 4').
+	//This lets instanced draws, which only know their primitive ID's, find each instance's proxy.
+	//Entries for primitives that aren't in the pass contain garbage.
+	//
+	//'Bounds' is a third ByteAddressBuffer, indexed by slot, containing each component's primitive bounds in world space:
+	//    two float4's (center and sphere radius, then box extent).
+	//Slots with no primitive have a negative radius.
+	//This is what 'EGP::AddComponentCullingPass()' reads.
+	struct FProxyGPUBuffer
+	{
+		FRDGBufferSRVRef SRV = nullptr;
+		uint32 Stride = 0;
+		//Can be zero; the buffers always have room for at least one slot, but it isn't valid to read.
+		uint32 NumSlots = 0;
+
+		FRDGBufferSRVRef PrimitiveSlots = nullptr;
+
+		static constexpr uint32 BoundsStride = sizeof(FVector4f) * 2;
+		FRDGBufferSRVRef Bounds = nullptr;
+	};
 } }
 
 #pragma region Component
 
+//Controls when a render-pass component sends its proxy data to the render thread.
+UENUM(BlueprintType)
+enum class E_EGP_ProxyUpdateMode : uint8
+{
+	//The proxy is rebuilt and sent to the render thread every frame.
+	EveryFrame,
+	//The proxy is rebuilt every frame, but only sent to the render thread
+	//    if its bytes (or the component's attach-parent) changed.
+	CompareBytes,
+	//The proxy is only rebuilt and sent after 'MarkProxyDirty()' is called (or the attach-parent changes).
+	//The pass skips the component entirely otherwise, so this is the best choice for static components.
+	OnlyWhenDirty
+};
+
 //Marks its parent component as being part of some custom render pass.
 UCLASS(Abstract, BlueprintType, Blueprintable, Placeable, meta=(BlueprintSpawnableComponent))
 class EXTENDEDGRAPHICSPROGRAMMING_API U_EGP_RenderPassComponent : public USceneComponent
@@ -378,20 +505,43 @@ public:
 	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category="Custom Render Pass")
 	bool EnabledInCustomPass = true;
 
+	//Controls how often this component's proxy is sent to the render thread.
+	//Change it at runtime with 'SetProxyUpdateMode()'.
+	UPROPERTY(BlueprintReadOnly, EditAnywhere, Category="Custom Render Pass")
+	E_EGP_ProxyUpdateMode ProxyUpdateMode = E_EGP_ProxyUpdateMode::EveryFrame;
+
 
 	U_EGP_RenderPassComponent();
-	
+
 	virtual void BeginPlay() override;
 	virtual void EndPlay(const EEndPlayReason::Type reason) override;
-	virtual void TickComponent(float deltaSeconds, ELevelTick tickType, FActorComponentTickFunction* thisTickFn) override;
+	virtual void OnAttachmentChanged() override;
+	virtual void BeginDestroy() override;
+	virtual bool IsReadyForFinishDestroy() override;
+
+	UFUNCTION(BlueprintCallable, Category="Custom Render Pass")
+	void SetProxyUpdateMode(E_EGP_ProxyUpdateMode newMode);
+	//Requests that this component's proxy (and target) be re-sent to the render thread on the pass's next tick.
+	//Required for changes to show up under the 'OnlyWhenDirty' update mode; harmless in other modes.
+	UFUNCTION(BlueprintCallable, Category="Custom Render Pass")
+	void MarkProxyDirty();
 
 	//Reports the kind of render pass this component is meant to be a part of.
 	virtual TSubclassOf<U_EGP_RenderPass> GetPassType() const
 		PURE_VIRTUAL(UCustomRenderPassComponent::GetPassType, return nullptr; )
+	//Reports the byte size of this component's POD struct for the render-thread.
+	//All components belonging to the same pass must use the same proxy struct.
+	virtual int32 GetProxyByteSize() const
+		PURE_VIRTUAL(UCustomRenderPassComponent::GetProxyByteSize, return 0; )
 	//Converts this component's data into a POD struct for the render-thread, constructing it in the given byte buffer.
+	//The buffer is 'GetProxyByteSize()' bytes long and aligned to 'EGP::CustomRenderPasses::ProxyAlignment'.
 	//You can usually implement this by just calling through to 'ImplConstructProxyData_GameThread()'.
-	virtual void ConstructProxyData_GameThread(EGP::CustomRenderPasses::ProxyData_t& output) const
+	virtual void ConstructProxyData_GameThread(std::byte* output) const
 		PURE_VIRTUAL(UCustomRenderPassComponent::ConstructProxyData_GameThread, )
+	//Override this to return true if 'ConstructProxyData_GameThread()' and 'GetProxyByteSize()'
+	//    only read from this component (or other data that isn't changing during the pass's tick),
+	//    allowing passes with 'ParallelProxyConstruction' to build your proxy on a worker thread.
+	virtual bool IsProxyConstructionThreadSafe() const { return false; }
 	//Destroys the POD struct representing this component.
 	//You must implement this by calling through to 'ImplDestructProxyData_GameThread()'.
 	virtual void DestructProxyData_GameThread() const
@@ -399,50 +549,80 @@ public:
 
 	//Grabs the most recent version of the render-thread data struct representing this component.
 	template<typename POD>
-	const POD& GetProxy_RenderThread() const { return reinterpret_cast<const POD&>(GetProxy_RenderThread()); }
-	const EGP::CustomRenderPasses::ProxyData_t& GetProxy_RenderThread() const { check(IsInRenderingThread()); return *renderThreadProxy.Get(); }
+	const POD& GetProxy_RenderThread() const { return *reinterpret_cast<const POD*>(GetProxy_RenderThread()); }
+	//Returns null if the proxy hasn't reached the render thread yet.
+	const std::byte* GetProxy_RenderThread() const;
 
-	UPrimitiveComponent* GetTarget_RenderThread() const { check(IsInRenderingThread()); return renderThreadTarget.Get(); }
+	UPrimitiveComponent* GetTarget_RenderThread() const;
+
+	//This component's index into the pass's GPU proxy buffer (see 'U_EGP_RenderPass::GetProxyBuffer_RenderThread()').
+	int32 GetProxySlot_RenderThread() const { return renderThreadSlot; }
 
 protected:
 
+	//The pass reads and writes this component's proxy state directly.
+	friend U_EGP_RenderPass;
+
 	//Implements the most common behavior for `CreateProxyData_RenderThread()`.
 	template<typename POD>
-	static void ImplConstructProxyData_GameThread(EGP::CustomRenderPasses::ProxyData_t& output, POD&& proxyData)
+	static void ImplConstructProxyData_GameThread(std::byte* output, POD&& proxyData)
 	{
-		output.SetNumUninitialized(sizeof(POD));
-		auto* proxyOutput = reinterpret_cast<POD*>(output.GetData());
-
-		new (proxyOutput) POD(proxyData);
+		static_assert(alignof(POD) <= EGP::CustomRenderPasses::ProxyAlignment,
+					  "Proxy struct has a larger alignment than EGP supports");
+		new (output) POD(MoveTemp(proxyData));
 	}
 	//Implements the most common behavior for `DestructProxyData_RenderThread()`.
 	template<typename POD>
 	void ImplDestructProxyData_GameThread() const
 	{
-		auto proxySharedPtr = renderThreadProxy;
-		ENQUEUE_RENDER_COMMAND(DestructCustomRenderPassComponentProxy)([proxySharedPtr](FRHICommandListImmediate&)
+		//This component can't finish being destroyed until the render thread is done with it,
+		//    so it's safe to reference it from a render command.
+		auto* _this = this;
+		ENQUEUE_RENDER_COMMAND(DestructCustomRenderPassComponentProxy)([_this](FRHICommandListImmediate&)
 		{
 			//If the proxy was never created, there's nothing to do.
-			if (proxySharedPtr->Num() == 0)
+			auto* proxy = reinterpret_cast<POD*>(_this->GetMutableProxy_RenderThread());
+			if (proxy == nullptr)
 				return;
-			
-			check(proxySharedPtr->Num() == sizeof(POD));
-			auto* proxy = reinterpret_cast<POD*>(proxySharedPtr->GetData());
-			
+
 			proxy->~POD();
 		});
 	}
 
 private:
 
-	TSharedPtr<EGP::CustomRenderPasses::ProxyData_t, ESPMode::ThreadSafe> renderThreadProxy;
-	TWeakObjectPtr<UPrimitiveComponent> renderThreadTarget;
+	//Mirrors this component's registration with its pass, on the render thread.
+	//Written by the pass.
+	mutable U_EGP_RenderPass* renderThreadPass = nullptr;
+	mutable int32 renderThreadSlot = INDEX_NONE;
+	std::byte* GetMutableProxy_RenderThread() const;
+
+	//This component's slot in the pass's proxy storage, on the game thread.
+	int32 gameThreadSlot = INDEX_NONE;
+
+	//Game-thread record of what was last sent to the render thread, for change detection.
+	TArray<std::byte> lastSentProxy;
+	const UPrimitiveComponent* lastSentTarget = nullptr;
+	bool isProxyDirty = true;
+
+	//Appends this component's proxy to the given batch if it needs to be re-sent.
+	//Returns whether anything was written.
+	bool WriteProxyUpdate_GameThread(EGP::CustomRenderPasses::FProxyUpdateBatch& batch);
+	//Constructs this component's proxy into the given memory if it needs to be re-sent,
+	//    filling in everything about the batch entry except the byte offset.
+	//Only touches this component's own state, so it can run on a worker thread if construction is thread-safe.
+	//Returns whether the proxy should be sent.
+	bool BuildProxyUpdate(std::byte* output, EGP::CustomRenderPasses::FProxyUpdateBatch::FEntry& outEntry);
+
+	//Keeps this component alive until the render thread has stopped referencing it.
+	FRenderCommandFence renderThreadFence;
 };
 
 //If your render pass component can set up its POD proxy by simply calling its constructor,
 //    then you can use this macro to implement the component's proxy virtual functions.
 #define EGP_PASS_COMPONENT_SIMPLE_PROXY_IMPL(TProxy, createExpr) \
-	virtual void ConstructProxyData_GameThread(EGP::CustomRenderPasses::ProxyData_t& output) const override { \
+	virtual int32 GetProxyByteSize() const override { return sizeof(TProxy); } \
+	virtual void ConstructProxyData_GameThread(std::byte* output) const override { \
 		TProxy localProxyInstance = (createExpr); \
 		ImplConstructProxyData_GameThread<TProxy>(output, MoveTemp(localProxyInstance)); \
 	} \
@@ -507,6 +687,21 @@ private:
 
 #pragma region Scene View Extension
 
+//Where in the frame a custom pass's SVE adds its compute work (see 'F_EGP_RenderPassSceneViewExtension::AddComputePasses_RenderThread()').
+//Earlier points give async-compute passes more graphics work to overlap with,
+//    but can see less of the current frame's data.
+enum class E_EGP_ComputeScheduling : uint8
+{
+	//Before the depth prepass; overlaps with the prepass, shadows, and base pass.
+	//This frame's scene textures don't exist yet.
+	BeforeScene,
+	//Right after the base pass; the GBuffer and depth are available, and the work overlaps with lighting.
+	//Only the deferred renderer has this point.
+	AfterBasePass,
+	//Just before post-processing, after lighting is done; most work here has nothing to overlap with.
+	BeforePostProcess
+};
+
 //The non-templated base class of 'TCustomRenderPassSceneViewExtension'.
 //Don't directly inherit from this.
 class EXTENDEDGRAPHICSPROGRAMMING_API F_EGP_RenderPassSceneViewExtension : public FSceneViewExtensionBase
@@ -542,6 +737,30 @@ public:
 	virtual void SetupView(FSceneViewFamily& InViewFamily, FSceneView& InView) override { }
 	virtual void BeginRenderViewFamily(FSceneViewFamily& InViewFamily) override { }
 
+	//When 'AddComputePasses_RenderThread()' is called each frame.
+	//Change it in your constructor; it's read on the render thread.
+	E_EGP_ComputeScheduling ComputeScheduling = E_EGP_ComputeScheduling::BeforePostProcess;
+
+	//Override this to add your pass's compute work (ideally with 'UseAsyncCompute')
+	//    at the point in the frame given by 'ComputeScheduling'. Called once per view.
+	virtual void AddComputePasses_RenderThread(FRDGBuilder& graph, const FViewInfo& view) { }
+
+	//These engine hooks schedule 'AddComputePasses_RenderThread()', so they're sealed.
+	//Override the 'On[X]' versions below instead; they're called first.
+	virtual void PreRenderView_RenderThread(FRDGBuilder& graph, FSceneView& view) override final;
+	virtual void PostRenderBasePassDeferred_RenderThread(FRDGBuilder& graph, FSceneView& view,
+														 const FRenderTargetBindingSlots& renderTargets,
+														 TRDGUniformBufferRef<FSceneTextureUniformParameters> sceneTextures) override final;
+	virtual void PrePostProcessPass_RenderThread(FRDGBuilder& graph, const FSceneView& view,
+												 const FPostProcessingInputs& inputs) override final;
+
+	virtual void OnPreRenderView_RenderThread(FRDGBuilder& graph, FSceneView& view) { }
+	virtual void OnPostRenderBasePassDeferred_RenderThread(FRDGBuilder& graph, FSceneView& view,
+														   const FRenderTargetBindingSlots& renderTargets,
+														   TRDGUniformBufferRef<FSceneTextureUniformParameters> sceneTextures) { }
+	virtual void OnPrePostProcessPass_RenderThread(FRDGBuilder& graph, const FSceneView& view,
+												   const FPostProcessingInputs& inputs) { }
+
 private:
 
 	std::atomic_bool stopAllRendering = false;
@@ -577,8 +796,9 @@ public:
 
 			if (filter->ShouldRenderFor(c))
 				return NullOpt;
-			else
-				return false;
+
+			me->Pass->RecordViewFilterReject();
+			return false;
 		};
 		IsActiveThisFrameFunctions.Add(testFilter);
 	}
@@ -586,6 +806,7 @@ public:
 	//Iterates over each renderable object for this custom pass and executes your lambda on it.
 	//The lambda's signature is:
 	//  `(const ComponentType&, const PrimitiveProxyType&,   const UPrimitiveComponent&, const FPrimitiveSceneProxy&) -> void`
+	//If the pass mirrors its proxies to the GPU, use 'component.GetProxySlot_RenderThread()' to index into that buffer.
 	template<typename Lambda>
 	void ForEachComponent_RenderThread(Lambda toDo)
 	{
@@ -597,45 +818,136 @@ public:
 		}
 		else
 		{
-			for (const auto& [_component, proxyBytes] : Pass->GetComponentData_RenderThread())
+			const auto& storage = Pass->GetComponentData_RenderThread();
+			for (int32 denseI = 0; denseI < storage.Num(); ++denseI)
+				VisitComponent(storage, denseI, toDo);
+		}
+	}
+
+	//Like 'ForEachComponent_RenderThread()', but splits the components across task-graph workers
+	//    (useful for gathering mesh draw commands in passes with thousands of primitives).
+	//
+	//Each worker task gets its own context object so that it can write its results without locking.
+	//The contexts are created up-front on the calling thread by 'makeContext', with signature
+	//  `(int32 contextIdx, int32 nContexts) -> TContext`,
+	//  and the lambda's signature becomes
+	//  `(TContext&, const ComponentType&, const PrimitiveProxyType&,   const UPrimitiveComponent&, const FPrimitiveSceneProxy&) -> void`.
+	//After this returns, merge or submit the contexts' results as you like.
+	template<typename TContext, typename ContextConstructor, typename Lambda>
+	void ParallelForEachComponent_RenderThread(TArray<TContext>& outContexts, ContextConstructor makeContext, Lambda toDo,
+											   int32 minBatchSize = 64)
+	{
+		check(IsInRenderingThread());
+		if constexpr (std::is_same_v<ComponentType, void>)
+		{
+			checkf(false, TEXT("You called 'ParallelForEachComponent_RenderThread(), in a scene-view extension "
+							     "that doesn't use components!"));
+		}
+		else
+		{
+			//Nothing modifies the storage until the next render command, so workers can read it freely.
+			const auto& storage = Pass->GetComponentData_RenderThread();
+			ParallelForWithTaskContext(TEXT("EGP.ForEachCustomPassComponent"),
+									   outContexts, storage.Num(), minBatchSize,
+									   makeContext,
+									   [&](TContext& context, int32 denseI)
 			{
-				//I'm not 100% sure how safe it is to use 'IsValid()' in this thread.
-				if (!_component.IsValid())
-					continue;
-
-				//Ideally I'd expect the user's custom pass
-				//    to grab its own pointer to each primitive component's render-proxy as desired
-				//    and store it in the custom pass component's proxy struct, on 'WriteProxyData_RenderThread()'.
-				//However in my experience that seems doomed to crash, and I can't for the life of me
-				//    see any function or engine code sample to know when a proxy stored that way
-				//    has been destroyed and recreated while I wasn't looking.
-				//So instead I grab the render proxy on demand, directly from the primitive-component.
-				//Primitive scene proxies are only changed on the render-thread so we should be safe from race conditions.
-				auto* primitiveComponent = _component->GetTarget_RenderThread();
-				
-				if (primitiveComponent == nullptr || primitiveComponent->SceneProxy == nullptr)
-					return;
-
-				//Not sure if it's safe to use CastChecked on this thread, so just do a raw reinterpret_cast.
-				auto* component = reinterpret_cast<const ComponentType*>(_component.Get());
-				const auto& proxy = reinterpret_cast<const PrimitiveProxyType&>(proxyBytes);
-				const auto* primitiveProxy = primitiveComponent->SceneProxy;
-
-				toDo(*component, proxy,    *primitiveComponent, *primitiveProxy);
-			}
+				VisitComponent(storage, denseI, [&](const auto&... args) { toDo(context, args...); });
+			});
 		}
 	}
+
+private:
+
+	template<typename Lambda>
+	static void VisitComponent(const EGP::CustomRenderPasses::FProxyStorage& storage, int32 denseI, Lambda&& toDo)
+	{
+		//Components can't finish dying until the render thread has unregistered them,
+		//    so every pointer in this collection is safe to use.
+		const auto& element = storage.GetElement(denseI);
+		if (!element.HasProxy)
+			return;
+
+		//Ideally I'd expect the user's custom pass
+		//    to grab its own pointer to each primitive component's render-proxy as desired
+		//    and store it in the custom pass component's proxy struct, on 'WriteProxyData_RenderThread()'.
+		//However in my experience that seems doomed to crash, and I can't for the life of me
+		//    see any function or engine code sample to know when a proxy stored that way
+		//    has been destroyed and recreated while I wasn't looking.
+		//So instead I grab the render proxy on demand, directly from the primitive-component.
+		//Primitive scene proxies are only changed on the render-thread so we should be safe from race conditions.
+		auto* primitiveComponent = element.Target.Get();
+
+		if (primitiveComponent == nullptr || primitiveComponent->SceneProxy == nullptr)
+			return;
+
+		//Not sure if it's safe to use CastChecked on this thread, so just do a raw reinterpret_cast.
+		auto* component = reinterpret_cast<const ComponentType*>(element.Component);
+		const auto& proxy = *reinterpret_cast<const PrimitiveProxyType*>(storage.GetProxy(denseI));
+		const auto* primitiveProxy = primitiveComponent->SceneProxy;
+
+		toDo(*component, proxy,    *primitiveComponent, *primitiveProxy);
+	}
 };
 
 #pragma endregion
 
 #pragma region Per-view Data
 
+//Recycles the GPU resources of per-view data that was cleaned up, so that new views don't have to allocate their own.
+//Owned by a T_EGP_PerViewData<>; render-thread only.
+struct EXTENDEDGRAPHICSPROGRAMMING_API F_EGP_ViewResourcePool
+{
+	//Pooled resources that go this many frames without being reused are released.
+	int CleanupFrameThreshold = 120;
+
+	//Creates a texture for the graph, reusing a pooled one with the same description if possible.
+	//'outPersistent' receives the texture so you can hold onto it across frames.
+	FRDGTextureRef CreateTexture(FRDGBuilder& graph, const FRDGTextureDesc& desc, const TCHAR* name,
+								 TRefCountPtr<IPooledRenderTarget>& outPersistent);
+	//Creates a buffer for the graph, reusing a pooled one with the same description if possible.
+	//'outPersistent' receives the buffer so you can hold onto it across frames.
+	FRDGBufferRef CreateBuffer(FRDGBuilder& graph, const FRDGBufferDesc& desc, const TCHAR* name,
+							   TRefCountPtr<FRDGPooledBuffer>& outPersistent);
+
+	//Gives a resource to the pool, leaving the reference null.
+	//Its contents are undefined by the time it's reused.
+	void Return(TRefCountPtr<IPooledRenderTarget>& texture);
+	void Return(TRefCountPtr<FRDGPooledBuffer>& buffer);
+
+	uint64 GetByteSize() const { return nBytes; }
+	static uint64 GetByteSize(const TRefCountPtr<IPooledRenderTarget>& texture) { return texture.IsValid() ? texture->ComputeMemorySize() : 0; }
+	static uint64 GetByteSize(const TRefCountPtr<FRDGPooledBuffer>& buffer) { return buffer.IsValid() ? buffer->Desc.GetSize() : 0; }
+
+	//Releases resources that haven't been reused recently.
+	void Tick();
+	//Releases the oldest resources until the pool is no bigger than the given size.
+	void Trim(uint64 maxBytes);
+	//Releases everything in the pool.
+	void Empty();
+
+private:
+
+	struct FEntry
+	{
+		TRefCountPtr<IPooledRenderTarget> Texture;
+		TRefCountPtr<FRDGPooledBuffer> Buffer;
+		uint64 ByteSize = 0;
+		int FramesInPool = 0;
+	};
+	//Ordered from oldest to newest.
+	TArray<FEntry> entries;
+	uint64 nBytes = 0;
+
+	void RemoveEntry(int32 i);
+};
+
 //Some persistent, per-view resources for a custom render pass.
 //Managed by a T_EGP_PerViewData<>.
 struct F_EGP_ViewPersistentData
 {
 	//Child constructors must have these parameters, followed by any custom ones.
+	//To reuse the resources of views that were cleaned up, pass the owner's 'ResourcePool' in as a custom parameter.
 	F_EGP_ViewPersistentData(FRDGBuilder&, const FViewInfo&, const FIntRect& viewportSubset) { }
 	
 	//You must define how to resample your data as the user's resolution or screen-percentage changes.
@@ -644,6 +956,12 @@ struct F_EGP_ViewPersistentData
 						  const FInt32Point& newResolution,
 						  const FInt32Point& oldToNewPixelOffset) = 0;
 
+	//Reports how much GPU memory this data holds onto, for the owner's memory budget.
+	//Consider using 'F_EGP_ViewResourcePool::GetByteSize()' on each resource.
+	virtual uint64 GetGPUByteSize() const { return 0; }
+	//Called right before this data is cleaned up, to give its resources to the pool for other views to reuse.
+	virtual void ReleaseResources(F_EGP_ViewResourcePool& pool) { }
+
 	
 	//Automatic copies are considered an error.
 	F_EGP_ViewPersistentData(const F_EGP_ViewPersistentData&) = delete;
@@ -656,6 +974,19 @@ struct F_EGP_ViewPersistentData
 };
 
 
+//Controls how a T_EGP_PerViewData<> reacts to its view changing resolution.
+enum class E_EGP_ViewResamplePolicy : uint8
+{
+	//The data always matches the view's exact resolution, and is resampled whenever the view rect changes at all.
+	Exact,
+	//The data's resolution is the view's, rounded up to a multiple of 'ResampleBucketSize',
+	//    and is only resampled when the view crosses into a different bucket.
+	Bucketed,
+	//The data's resolution is the largest the view can have (its resolution before screen-percentage and dynamic resolution),
+	//    and only grows if the view somehow exceeds it.
+	MaxResolution
+};
+
 //Non-templated base class of T_EGP_PerViewData, to expose some of its more general behavior.
 struct F_EGP_PerViewData
 {
@@ -679,27 +1010,58 @@ struct T_EGP_PerViewData final : public F_EGP_PerViewData
 	int CleanupFrameThreshold = 60;
 	//If a view's ID is in this set, it is never eligible for being cleaned up.
 	TSet<int> CleanupPreventionByViewID;
-	
+
+	//If nonzero, the total GPU memory of all views plus the resource pool is kept under this many bytes
+	//    by cleaning up the least-recently-used views early, and then shrinking the pool.
+	//Views used in the previous frame, and permanent views, are never cleaned up early.
+	//Relies on your data implementing 'GetGPUByteSize()'.
+	uint64 MemoryBudgetBytes = 0;
+
+	//Resources from cleaned-up views go here, for new views to reuse.
+	F_EGP_ViewResourcePool ResourcePool;
+
+	//With anything other than 'Exact', your data is allocated bigger than the view
+	//    and should only use the part that the view covers (like the engine's history buffers);
+	//    the view's current resolution is always 'view.ViewRect.Size()'.
+	//Worth using when dynamic resolution is on, as the view's resolution changes nearly every frame.
+	E_EGP_ViewResamplePolicy ResamplePolicy = E_EGP_ViewResamplePolicy::Exact;
+	int ResampleBucketSize = 256;
+
 	//Should be called once per frame on the render thread.
-	//Cleans up view data that hasn't been used in a while.
+	//Cleans up view data that hasn't been used in a while, and enforces the memory budget.
 	virtual void Tick() override final 
 	{
 		check(IsInRenderingThread());
 
-		viewIDBuffer.Empty();
-		dataByViewID.GetKeys(viewIDBuffer);
-		for (int viewID : viewIDBuffer)
+		uint64 nViewBytes = 0;
+		for (auto it = dataByViewID.CreateIterator(); it; ++it)
 		{
 			//Don't advance the timestamp at all for views that are permanent.
-			if (CleanupPreventionByViewID.Contains(viewID))
+			auto& data = it->Value;
+			if (CleanupPreventionByViewID.Contains(it->Key))
+			{
+				nViewBytes += data.User.GetGPUByteSize();
 				continue;
-			
-			auto& data = dataByViewID[viewID];
+			}
+
 			if (data.FramesSinceAccess > CleanupFrameThreshold)
-				dataByViewID.Remove(viewID);
+			{
+				data.User.ReleaseResources(ResourcePool);
+				it.RemoveCurrent();
+			}
 			else
+			{
 				data.FramesSinceAccess += 1;
+				nViewBytes += data.User.GetGPUByteSize();
+			}
 		}
+
+		if (MemoryBudgetBytes > 0 && nViewBytes > MemoryBudgetBytes)
+			EvictForBudget(nViewBytes);
+
+		ResourcePool.Tick();
+		if (MemoryBudgetBytes > 0)
+			ResourcePool.Trim((nViewBytes < MemoryBudgetBytes) ? (MemoryBudgetBytes - nViewBytes) : 0);
 	}
 
 	//Gets the data for the given view, creating new data if none is registered.
@@ -718,10 +1080,11 @@ struct T_EGP_PerViewData final : public F_EGP_PerViewData
 		auto* data = dataByViewID.Find(viewID);
 		if (data == nullptr)
 		{
+			FIntRect allocatedRect{ view.ViewRect.Min, view.ViewRect.Min + GetAllocatedResolution(view, { 0, 0 }) };
 			data = &dataByViewID.Emplace(viewID, ViewData{
-				TData{ graph, view, view.ViewRect,
+				TData{ graph, view, allocatedRect,
 						    Forward<NewDataArgs>(constructorArgs)... },
-				view.ViewRect,
+				allocatedRect,
 				view.GetFeatureLevel(),
 				0
 			});
@@ -731,12 +1094,27 @@ struct T_EGP_PerViewData final : public F_EGP_PerViewData
 		data->FramesSinceAccess = 0;
 
 		//Resample the asset if needed.
-		if (data->PixelSubset != view.ViewRect)
+		if (ResamplePolicy == E_EGP_ViewResamplePolicy::Exact)
 		{
-			data->User.Resample(graph, view,
-								data->PixelSubset.Size(), view.ViewRect.Size(),
-								view.ViewRect.Min - data->PixelSubset.Min);
-			data->PixelSubset = view.ViewRect;
+			if (data->PixelSubset != view.ViewRect)
+			{
+				data->User.Resample(graph, view,
+									data->PixelSubset.Size(), view.ViewRect.Size(),
+									view.ViewRect.Min - data->PixelSubset.Min);
+				data->PixelSubset = view.ViewRect;
+			}
+		}
+		//The other policies store data relative to the view rect, so only its size matters.
+		else
+		{
+			FIntPoint newResolution = GetAllocatedResolution(view, data->PixelSubset.Size());
+			if (newResolution != data->PixelSubset.Size())
+			{
+				data->User.Resample(graph, view,
+									data->PixelSubset.Size(), newResolution,
+									{ 0, 0 });
+			}
+			data->PixelSubset = { view.ViewRect.Min, view.ViewRect.Min + newResolution };
 		}
 
 		return data->User;
@@ -776,8 +1154,54 @@ private:
 	};
 	TMap<int, ViewData> dataByViewID;
 
-	//Used inside Tick()
-	TArray<int> viewIDBuffer;
+	//Gets the resolution that a view's data should have, based on 'ResamplePolicy'.
+	FIntPoint GetAllocatedResolution(const FViewInfo& view, const FIntPoint& currentResolution) const
+	{
+		const FIntPoint viewResolution = view.ViewRect.Size();
+		switch (ResamplePolicy)
+		{
+			case E_EGP_ViewResamplePolicy::Exact:
+				return viewResolution;
+
+			case E_EGP_ViewResamplePolicy::Bucketed: {
+				const int bucketSize = FMath::Max(1, ResampleBucketSize);
+				return {
+					FMath::DivideAndRoundUp(viewResolution.X, bucketSize) * bucketSize,
+					FMath::DivideAndRoundUp(viewResolution.Y, bucketSize) * bucketSize
+				};
+			}
+
+			case E_EGP_ViewResamplePolicy::MaxResolution:
+				return currentResolution.ComponentMax(viewResolution)
+										.ComponentMax(view.UnscaledViewRect.Size());
+
+			default: check(false); return viewResolution;
+		}
+	}
+
+	//Cleans up the least-recently-used views until the rest fit in the budget.
+	void EvictForBudget(uint64& nViewBytes)
+	{
+		//Views used last frame aren't candidates (Tick() already advanced their timestamp to 1).
+		evictionBuffer.Reset();
+		for (const auto& [id, data] : dataByViewID)
+			if (data.FramesSinceAccess > 1 && !CleanupPreventionByViewID.Contains(id))
+				evictionBuffer.Emplace(data.FramesSinceAccess, id);
+		evictionBuffer.Sort([](const auto& a, const auto& b) { return a.Key > b.Key; });
+
+		for (const auto& [framesSinceAccess, viewID] : evictionBuffer)
+		{
+			if (nViewBytes <= MemoryBudgetBytes)
+				break;
+
+			auto& data = dataByViewID[viewID];
+			nViewBytes -= FMath::Min(nViewBytes, data.User.GetGPUByteSize());
+			data.User.ReleaseResources(ResourcePool);
+			dataByViewID.Remove(viewID);
+		}
+	}
+	//Used inside EvictForBudget()
+	TArray<TPair<int, int>> evictionBuffer;
 };
 
 #pragma endregion
@@ -799,10 +1223,50 @@ public:
 
 	const auto& GetComponentData_RenderThread() const { check(IsInRenderingThread()); return ComponentProxies_RenderThread; }
 
+	//Gets the GPU copy of every component's proxy, uploading any slots that changed since the last call.
+	//Only available if 'MirrorProxiesToGPU' is enabled; otherwise the returned SRV is null.
+	//Safe to call multiple times per frame, and from multiple graphs.
+	EGP::CustomRenderPasses::FProxyGPUBuffer GetProxyBuffer_RenderThread(FRDGBuilder& graph);
+
+	//Counts a view that was rejected by the 'ViewFilter', for this pass's stats.
+	//Called by the pass's scene-view extension; thread-safe.
+	void RecordViewFilterReject() { nViewFilterRejects.fetch_add(1, std::memory_order_relaxed); }
+
 	//The filter settings, controlling which views use this render pass.
 	UPROPERTY(BlueprintReadOnly, VisibleInstanceOnly, Transient)
 	U_EGP_ViewFilter* const ViewFilter = nullptr;
 
+	//If true, proxies of components that report 'IsProxyConstructionThreadSafe()'
+	//    are built in parallel on task-graph workers.
+	//Worth enabling for passes with many thousands of components.
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Config, Category="Custom Render Pass")
+	bool ParallelProxyConstruction = false;
+
+	//If true, the components' proxies are mirrored into a persistent GPU buffer
+	//    for your shaders to read (see 'GetProxyBuffer_RenderThread()').
+	//Only the proxies that changed are uploaded each frame.
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Config, Category="Custom Render Pass")
+	bool MirrorProxiesToGPU = false;
+
+	//If above zero, the subsystem ticks this pass at most this many times per second
+	//    (both the game-thread and render-thread ticks), instead of every frame.
+	//Between ticks the render thread keeps using the last proxies it was sent.
+	//Components still register and unregister immediately, and 'ViewFilter' changes still sync every frame.
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Config, Category="Custom Render Pass", meta=(ClampMin=0))
+	float MaxTicksPerSecond = 0;
+
+	//If true, each tick only refreshes a rotating subset of the components' proxies,
+	//    sized to fit in 'ProxyUpdateBudgetMicroseconds'.
+	//Components that weren't refreshed keep their last-known proxy on the render thread.
+	//Newly-registered components are always refreshed on the next tick.
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Config, Category="Custom Render Pass")
+	bool TimeSliceProxyUpdates = false;
+	//The game-thread time each tick may spend refreshing proxies, when 'TimeSliceProxyUpdates' is on.
+	//The number of components this buys is estimated from previous ticks, so it's a target rather than a hard limit.
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Config, Category="Custom Render Pass",
+			  meta=(EditCondition=TimeSliceProxyUpdates, ClampMin=1))
+	float ProxyUpdateBudgetMicroseconds = 500;
+
 	
 protected:
 
@@ -838,13 +1302,83 @@ protected:
 	
 	UPROPERTY(BlueprintReadOnly, VisibleInstanceOnly, Transient, DisplayName="Registered Components")
 	TSet<U_EGP_RenderPassComponent*> Components_GameThread;
-	TMap<TWeakObjectPtr<const U_EGP_RenderPassComponent>, EGP::CustomRenderPasses::ProxyData_t> ComponentProxies_RenderThread;
+	//Persists across frames; only components whose proxies changed are touched each frame.
+	EGP::CustomRenderPasses::FProxyStorage ComponentProxies_RenderThread;
 
 	
 private:
 
-	bool warnedAboutArrayHeapUsage = false;
-	bool warnedAboutProxyHeapUsage = false;
+	//Copies a frame's worth of proxy changes into the render-thread state.
+	void ApplyProxyUpdates_RenderThread(const EGP::CustomRenderPasses::FProxyUpdateBatch& batch);
+
+	//Disconnects every component from this pass's render-thread storage, when the pass is dying.
+	void ReleaseComponents_RenderThread();
+
+	//The GPU mirror of 'ComponentProxies_RenderThread'.
+	bool mirrorProxiesToGPU_RenderThread = false;
+	TRefCountPtr<FRDGPooledBuffer> gpuProxies_RenderThread;
+	int32 gpuProxyStride_RenderThread = 0;
+	//Slots whose proxy changed since the last upload.
+	TSet<int32> gpuDirtySlots_RenderThread;
+	//The GPU map from primitive ID to slot, the GPU bounds of each slot,
+	//    and the primitive data last uploaded for each slot.
+	TRefCountPtr<FRDGPooledBuffer> gpuPrimitiveSlots_RenderThread,
+								  gpuSlotBounds_RenderThread;
+	struct FGPUSlotPrimitive
+	{
+		int32 PrimitiveIdx = INDEX_NONE;
+		FVector4f Sphere{ 0, 0, 0, -1 };
+		FVector3f Extent{ 0, 0, 0 };
+		bool IsUploaded = false;
+	};
+	TArray<FGPUSlotPrimitive> gpuSlotPrimitives_RenderThread;
+
+	//Slots for the proxy storage are handed out on the game thread.
+	TArray<int32> freeSlots_GameThread;
+	int32 nSlots_GameThread = 0;
+	//The proxy size reported by the first registered component.
+	int32 proxyByteSize_GameThread = INDEX_NONE;
+
+	//Used inside Tick_GameThread() for parallel proxy construction.
+	TArray<U_EGP_RenderPassComponent*> parallelComponentsBuffer;
+
+	//Throttling from 'MaxTicksPerSecond', managed by the subsystem.
+	bool hasTicked_GameThread = false;
+	float secondsSinceTick_GameThread = 0;
+
+	//Time-slicing from 'TimeSliceProxyUpdates'.
+	//The components are visited in a stable order, rebuilt only when one registers or unregisters.
+	TArray<U_EGP_RenderPassComponent*> timeSliceOrder_GameThread;
+	bool timeSliceOrderIsDirty_GameThread = true;
+	int32 timeSliceCursor_GameThread = 0;
+	//Components that haven't sent their first proxy yet; they skip the queue.
+	//Only tracked while time-slicing.
+	TArray<U_EGP_RenderPassComponent*> timeSliceNewComponents_GameThread;
+	TSet<U_EGP_RenderPassComponent*> timeSliceVisitedNew_GameThread;
+	//A running estimate of the cost of refreshing one component, used to size each slice.
+	double timeSliceCyclesPerComponent_GameThread = 0;
+	//Picks this tick's components, per the time-slicing settings, and passes each one to 'toDo'.
+	//Returns the number of components visited.
+	int32 ForEachTimeSlicedComponent_GameThread(TFunctionRef<void(U_EGP_RenderPassComponent*)> toDo);
+
+	//Proxy batches come back from the render thread once they're applied, to be refilled next frame.
+	TQueue<TUniquePtr<EGP::CustomRenderPasses::FProxyUpdateBatch>, EQueueMode::Spsc> recycledBatches;
+
+	bool warnedAboutProxySizeMismatch = false;
+
+	//Stats collected between game-thread ticks, then reported to 'STATGROUP_EGP' and the CSV profiler.
+	//'STATGROUP_EGP' sums every pass together; only the CSV stats are broken down per pass type.
+	std::atomic<int32> nViewFilterRejects = 0;
+	int32 nRenderCommands_GameThread = 0;
+	//Called every frame. On frames skipped by 'MaxTicksPerSecond' there's no batch,
+	//    and only the stats that don't depend on one are reported.
+	void ReportStats_GameThread(const EGP::CustomRenderPasses::FProxyUpdateBatch* batch, int32 nOversizedProxies);
+	//The CSV stats are named after the pass type, so they're made on first use.
+	struct FCsvStatNames
+	{
+		FName Components, ProxyUpdates, ProxyBytes, OversizedProxies, RenderCommands, ViewFilterRejects;
+	};
+	TOptional<FCsvStatNames> csvStatNames;
 };
 
 #pragma endregion
\ No newline at end of file
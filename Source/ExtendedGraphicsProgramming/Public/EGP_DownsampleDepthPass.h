@@ -14,4 +14,24 @@ namespace EGP
 		FScreenPassTexture input, FScreenPassRenderTarget output,
 		EDownsampleDepthFilter sampling
 	);
+
+	//One input/output pair for 'AddDownsampleDepthComputePass()'.
+	//Each texture's 'ViewRect' is the region to read from/write to.
+	struct FDownsampleDepthJob
+	{
+		FScreenPassTexture Input;
+		//Must support UAV's, so it can't be a depth-stencil target; use e.g. PF_R32_FLOAT
+		//    (or PF_G32R32F for 'EDownsampleDepthFilter::MinAndMaxDepth').
+		FScreenPassTexture Output;
+	};
+
+	//A compute version of 'AddDownsampleDepthPass()' which can run on the async-compute pipe,
+	//    and downsamples several textures at once (e.g. for split-screen or multiple Scene Captures).
+	//Up to 4 jobs share each dispatch.
+	EXTENDEDGRAPHICSPROGRAMMING_API void AddDownsampleDepthComputePass(
+		FRDGBuilder& builder, ERHIFeatureLevel::Type featureLevel,
+		TConstArrayView<FDownsampleDepthJob> jobs,
+		EDownsampleDepthFilter sampling,
+		bool asyncCompute = false
+	);
 }
\ No newline at end of file
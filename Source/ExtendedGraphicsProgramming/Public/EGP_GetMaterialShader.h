@@ -18,6 +18,9 @@ namespace EGP
 	{
 		const FMaterialShaderMap* Map = nullptr;
 		FMaterialShaders Shaders;
+		//The post-process inputs ('PostProcessInput0' etc.) that the shader map reads, as a bitmask.
+		//Only filled in by 'FindMaterialShadersCached_RenderThread()', which computes it once per cached lookup.
+		uint32 UsedPostProcessInputs = 0;
 	};
 
 	//Parameters to compiling a Material against a shader.
@@ -39,6 +42,23 @@ namespace EGP
 	EXTENDEDGRAPHICSPROGRAMMING_API TOptional<FShaderMapFindResult> FindMaterialShaders_RenderThread(const UMaterialInterface* uMaterial,
 																					 		         const FMaterialShaderTypes& shaderTypes,
 																							         FShaderMapFindSettings settings);
+	//Same as 'FindMaterialShaders_RenderThread()', but remembers the result across frames.
+	//Cached results are thrown out if the Material's shader map changes, or if they go unused for a while.
+	EXTENDEDGRAPHICSPROGRAMMING_API TOptional<FShaderMapFindResult> FindMaterialShadersCached_RenderThread(const UMaterialInterface* uMaterial,
+																										   const FMaterialShaderTypes& shaderTypes,
+																										   FShaderMapFindSettings settings);
+	//Finds the given shaders ahead of time and creates their RHI resources,
+	//    so that the first pass using them doesn't hitch.
+	//Good to call from a custom pass's 'InitThisPass_RenderThread()'.
+	//Returns false if the shaders aren't available yet (e.g. they're still compiling).
+	//In the editor, missing shaders are then requested from the Material's compiler;
+	//    call this again later to create their RHI resources once they arrive.
+	EXTENDEDGRAPHICSPROGRAMMING_API bool PrecacheMaterialShaders_RenderThread(const UMaterialInterface* uMaterial,
+																			  const FMaterialShaderTypes& shaderTypes,
+																			  FShaderMapFindSettings settings);
+	//Clears the cache used by 'FindMaterialShadersCached_RenderThread()'.
+	EXTENDEDGRAPHICSPROGRAMMING_API void ClearMaterialShaderCache_RenderThread();
+
 	//Tries to compile the given material shader(s) against a Material graph,
 	//    iterating through fallback Materials until we find an applicable one.
 	//
@@ -2,6 +2,7 @@
 
 #include "CoreMinimal.h"
 #include "PrimitiveSceneInfo.h"
+#include "MeshPassProcessor.h"
 #include "Runtime/Renderer/Private/SceneRendering.h"
 
 namespace EGP
@@ -20,6 +21,12 @@ namespace EGP
     //In my experience it always ouptuts an empty range for static mesh components, even Movable ones.
     EXTENDEDGRAPHICSPROGRAMMING_API FInt32Range GetDynamicMeshElementRange(const FViewInfo& info, uint32 primitiveIndex);
 
+	//Picks which LOD('s) of a primitive's static meshes the view should draw,
+	//    the same way the engine's visibility pass does (including forced LOD's and dithered LOD transitions).
+	EXTENDEDGRAPHICSPROGRAMMING_API FLODMask GetStaticMeshLODs(const FViewInfo& info, const FPrimitiveSceneInfo& sceneInfo);
+	//Gets the batch element mask for one of a primitive's static meshes in the given view.
+	EXTENDEDGRAPHICSPROGRAMMING_API uint64 GetStaticMeshElementMask(const FViewInfo& info, const FStaticMeshBatch& staticMesh);
+
 	
     //Generates mesh batches for a custom Mesh Pass Processor, on the given primitive.
 	//
@@ -44,13 +51,17 @@ namespace EGP
     	const auto& primitiveRelevance = viewInfo.PrimitiveViewRelevanceMap[primitiveIdx];
     	if (primitiveRelevance.bStaticRelevance)
     	{
+    		auto lods = GetStaticMeshLODs(viewInfo, *sceneInfo);
     		for (int staticMeshIdx = 0; staticMeshIdx < sceneInfo->StaticMeshes.Num(); ++staticMeshIdx)
     		{
     			const auto& staticMesh = sceneInfo->StaticMeshes[staticMeshIdx];
-    			if (viewInfo.StaticMeshVisibilityMap[staticMesh.Id])
+    			if (!viewInfo.StaticMeshVisibilityMap[staticMesh.Id] || !lods.ContainsLOD(staticMesh.LODIndex))
+    				continue;
+
+    			uint64 batchElementMask = GetStaticMeshElementMask(viewInfo, staticMesh);
+    			if (batchElementMask != 0)
     			{
-    				uint64 defaultBatchElementMask = ~0ull; //TODO: Can we get this somehow from LOD data?
-    				batchProcessor(staticMesh, defaultBatchElementMask,
+    				batchProcessor(staticMesh, batchElementMask,
     							   staticMesh.PrimitiveSceneInfo->Proxy,
     							   staticMeshIdx);
     			}
@@ -72,9 +83,174 @@ namespace EGP
     		for (int32 batchI = dynamicElementRange.GetLowerBoundValue(); batchI < dynamicElementRange.GetUpperBoundValue(); ++batchI)
     		{
     			const FMeshBatchAndRelevance& data = viewInfo.DynamicMeshElements[batchI];
+    			//Dynamic elements were already generated for the view's chosen LOD.
     			uint64 batchElementMask = ~0ull;
     			batchProcessor(*data.Mesh, batchElementMask, data.PrimitiveSceneProxy, -1);
     		}
     	}
     }
+
+	//Keeps the mesh draw commands of static primitives across frames, so that
+	//    each frame only has to handle visibility and submission for them (like the engine's cached mesh passes).
+	//Dynamic primitives are still built from scratch every frame.
+	//
+	//Cached commands are rebuilt when the primitive's scene proxy, Materials, or GPU-scene placement change,
+	//    and are dropped once a primitive hasn't been seen for a while.
+	//Render-thread only.
+	class EXTENDEDGRAPHICSPROGRAMMING_API FCachedMeshDrawCommands
+	{
+	public:
+
+		//The draw commands gathered for one view, to be submitted later.
+		//Must stay alive until submission, so allocate it from the render graph: 'graph.AllocObject<FViewCommands>()'.
+		struct FViewCommands
+		{
+			FDynamicMeshDrawCommandStorage DynamicStorage;
+			FMeshCommandOneFrameArray Visible;
+			FGraphicsMinimalPipelineStateSet PipelineStates;
+			bool NeedsShaderInitialisation = false;
+		};
+
+		//Cached primitives are dropped after this many frames without being gathered.
+		uint64 TimeoutFrames = 120;
+		//If true, identical static draw commands from different primitives are merged into instanced draws
+		//    (the same way the engine merges its cached mesh passes; requires GPU-Scene).
+		//Commands are only identical if your Mesh Pass Processor binds the same shader parameters for each primitive,
+		//    so per-component data should come from the GPU-Scene primitive ID
+		//    (e.g. through the pass's 'FProxyGPUBuffer::PrimitiveSlots').
+		//Changes only affect commands built afterwards; call 'Reset()' to apply it to everything.
+		bool MergeInstances = true;
+
+		FCachedMeshDrawCommands() = default;
+		~FCachedMeshDrawCommands();
+		UE_NONCOPYABLE(FCachedMeshDrawCommands);
+
+		//Gathers draw commands for the given primitive into the view's list,
+		//    using cached commands for its static meshes when they're still valid.
+		//
+		//The lambda builds commands with your Mesh Pass Processor. Its signature should be
+		//    (FMeshPassDrawListContext*, const FMeshBatch&, uint64 elementMask, const FPrimitiveSceneProxy*, int staticMeshIDIfApplicable) -> void
+		//For static meshes it's only called when the cache needs to be rebuilt,
+		//    so it must not depend on anything that changes per-frame.
+		//Static meshes are built for every LOD and element; the view's LOD and element masks are applied to the cached commands.
+		//
+		//Can be called from several render tasks at once (e.g. with the SVE's 'ParallelForEachComponent_RenderThread()'),
+		//    as long as each task has its own 'output' and your lambda is thread-safe.
+		template<typename Lambda>
+		void GatherPrimitive(const FViewInfo& viewInfo, const FPrimitiveSceneProxy* proxy,
+							 FViewCommands& output, Lambda buildCommands)
+		{
+			if (!proxy)
+				return;
+
+			auto* sceneInfo = proxy->GetPrimitiveSceneInfo();
+			if (!sceneInfo || !sceneInfo->IsIndexValid())
+				return;
+
+			int primitiveIdx = sceneInfo->GetIndex();
+			if (!viewInfo.PrimitiveVisibilityMap[primitiveIdx])
+				return;
+			const auto& primitiveRelevance = viewInfo.PrimitiveViewRelevanceMap[primitiveIdx];
+
+			if (primitiveRelevance.bStaticRelevance)
+			{
+				GatherStaticCommands(viewInfo, *sceneInfo, output,
+									 [&](FMeshPassDrawListContext* context, const FMeshBatch& batch, int staticMeshIdx)
+				{
+					buildCommands(context, batch, ~0ull, proxy, staticMeshIdx);
+				});
+			}
+			if (primitiveRelevance.bDynamicRelevance)
+			{
+				FDynamicPassMeshDrawListContext context(output.DynamicStorage, output.Visible,
+														output.PipelineStates, output.NeedsShaderInitialisation);
+				auto dynamicElementRange = GetDynamicMeshElementRange(viewInfo, primitiveIdx);
+				for (int32 batchI = dynamicElementRange.GetLowerBoundValue(); batchI < dynamicElementRange.GetUpperBoundValue(); ++batchI)
+				{
+					const FMeshBatchAndRelevance& data = viewInfo.DynamicMeshElements[batchI];
+					buildCommands(&context, *data.Mesh, ~0ull, data.PrimitiveSceneProxy, -1);
+				}
+			}
+		}
+
+		//Sorts and draws everything gathered for the view.
+		//Call this inside your RDG raster pass.
+		static void Submit(const FViewInfo& viewInfo, FViewCommands& commands, FRHICommandList& cmds,
+						   bool forceStereoInstancingOff = false);
+		//Draws everything gathered for the view by several parallel tasks.
+		//Each task's commands are sorted and merged separately, because their dynamic draws
+		//    reference that task's own pipeline-state set.
+		static void Submit(const FViewInfo& viewInfo, TArrayView<FViewCommands* const> taskCommands, FRHICommandList& cmds,
+						   bool forceStereoInstancingOff = false);
+
+		//Drops primitives that haven't been gathered recently.
+		//Call once per frame, before any gathering (e.g. in your SVE's 'PreRenderViewFamily_RenderThread()').
+		void Tick();
+
+		//Throws out every cached command.
+		void Reset();
+
+	private:
+
+		struct FCachedCommand
+		{
+			FMeshDrawCommand Command;
+			int StaticMeshIdx = INDEX_NONE,
+				BatchElementIdx = 0;
+			FGraphicsMinimalPipelineStateId PipelineID;
+			FMeshDrawCommandPrimitiveIdInfo IdInfo;
+			ERasterizerFillMode FillMode = FM_Solid;
+			ERasterizerCullMode CullMode = CM_None;
+			FMeshDrawCommandSortKey SortKey = FMeshDrawCommandSortKey::Default;
+			EFVisibleMeshDrawCommandFlags Flags = EFVisibleMeshDrawCommandFlags::Default;
+			FMeshDrawCommandCullingPayload CullingPayload;
+			//Identical commands share a state bucket, which lets them be merged into one instanced draw.
+			int32 StateBucketId = INDEX_NONE;
+		};
+		struct FPrimitiveEntry
+		{
+			//The state of the primitive when its commands were built.
+			//The component ID is never reused, so it tells apart primitives that end up with the same index or addresses.
+			FPrimitiveComponentId ComponentId;
+			const FPrimitiveSceneInfo* SceneInfo = nullptr;
+			const FPrimitiveSceneProxy* Proxy = nullptr;
+			int32 PrimitiveIndex = INDEX_NONE,
+				  InstanceSceneDataOffset = INDEX_NONE;
+			TArray<TPair<const FMaterial*, const FMaterialShaderMap*>, TInlineAllocator<4>> Materials;
+
+			TArray<FCachedCommand> Commands;
+			uint64 LastUsedFrame = 0;
+
+			//Views gathered in parallel can reach the same primitive at once.
+			FCriticalSection Lock;
+		};
+		//Keyed on the primitive's persistent index, which (unlike its scene-info pointer)
+		//    can't be shared by two live primitives.
+		//Entries are boxed so that the commands don't move while views still reference them.
+		TMap<int32, TUniquePtr<FPrimitiveEntry>> entries;
+		//Guards 'entries' during parallel gathering.
+		//Each entry has its own lock for its contents.
+		FCriticalSection entriesLock;
+
+		struct FStateBucket
+		{
+			FMeshDrawCommand Command;
+			int32 NumUsers = 0;
+		};
+		TSparseArray<FStateBucket> stateBuckets;
+		TMultiMap<uint64, int32> stateBucketsByHash;
+		FCriticalSection stateBucketsLock;
+
+		//Writes new draw commands into a cached entry.
+		class FCachingContext;
+
+		void GatherStaticCommands(const FViewInfo& viewInfo, const FPrimitiveSceneInfo& sceneInfo, FViewCommands& output,
+								  TFunctionRef<void(FMeshPassDrawListContext*, const FMeshBatch&, int)> buildCommands);
+		static bool IsEntryValid(const FPrimitiveEntry& entry, const FPrimitiveSceneInfo& sceneInfo,
+								 ERHIFeatureLevel::Type featureLevel);
+		void ReleaseEntry(FPrimitiveEntry& entry);
+
+		int32 AcquireStateBucket(const FMeshDrawCommand& command);
+		void ReleaseStateBucket(int32 id);
+	};
 }
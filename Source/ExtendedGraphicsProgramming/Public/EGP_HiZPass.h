@@ -0,0 +1,41 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+#include "ScreenPass.h"
+
+
+namespace EGP
+{
+	//Which depth values a Hi-Z pyramid keeps.
+	//Unreal uses reversed-Z, so the min device-Z is the furthest depth and the max is the closest.
+	enum class EHiZMode : uint8
+	{
+		Min,
+		Max,
+		//Two channels: (min, max).
+		MinAndMax
+	};
+
+	//A depth pyramid built by 'AddHiZPass()'.
+	//Its layout matches the engine's HZB: mip 0 is half the view's resolution, rounded up to a power of two.
+	struct FHiZPyramid
+	{
+		FRDGTextureRef Texture = nullptr;
+		EHiZMode Mode = EHiZMode::Min;
+		FIntPoint Mip0Size = { 0, 0 };
+		//Converts a UV in the view rect to a UV in the pyramid texture.
+		FVector2f ViewportUVToHZBUV = { 1, 1 };
+	};
+
+	//Builds a full min, max, or min+max depth pyramid in a single compute dispatch.
+	//Only the input's view rect is read, so depth buffers bigger than their view (e.g. from Scene Captures) work correctly.
+	//
+	//Binds one UAV per mip, so it needs an RHI that allows at least 14 UAV's per dispatch (e.g. D3D12, Vulkan, Metal)
+	//    and supports views up to 8192 pixels on a side.
+	EXTENDEDGRAPHICSPROGRAMMING_API FHiZPyramid AddHiZPass(
+		FRDGBuilder& graph, ERHIFeatureLevel::Type featureLevel,
+		FScreenPassTexture depth,
+		EHiZMode mode = EHiZMode::Min
+	);
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/BlendableInterface.h"
+#include "MaterialShared.h"
+
+#include "EGP_MaterialShaderSettings.generated.h"
+
+
+//Which post-process Materials one EGP Material shader type compiles for.
+USTRUCT()
+struct EXTENDEDGRAPHICSPROGRAMMING_API F_EGP_MaterialShaderPermutationRule
+{
+	GENERATED_BODY()
+
+	//The name your shader passes to 'ShouldCompilePermutationFor()', usually its class name (e.g. "FMyPassPS").
+	UPROPERTY(EditAnywhere, Config)
+	FString ShaderType;
+
+	//The shader only compiles for post-process Materials using one of these Blendable Locations.
+	UPROPERTY(EditAnywhere, Config)
+	TArray<TEnumAsByte<EBlendableLocation>> BlendableLocations;
+};
+
+//Limits which post-process Materials get permutations of EGP's Material shaders.
+//By default every EGP shader type compiles for every post-process Material in the project,
+//    so compile times and shader-map memory grow with (EGP shader types x post-process Materials).
+//
+//Unreal shares shader-map layouts between all Materials with the same compilation parameters,
+//    so a shader can't tell Materials apart by name; instead Materials opt in through their Blendable Location.
+//EGP passes ignore that setting, so pick a location that the project's ordinary post-process Materials don't use
+//    (e.g. "SSR Input") and give it to every Material meant for EGP passes.
+//The engine's default Materials always compile, so 'EMissingShaderPolicy::UseFallbackMaterial' keeps working
+//    (though a custom 'FallbackMaterial' has to opt in like any other).
+//
+//Configured in the plugin's ini under '[/Script/ExtendedGraphicsProgramming._EGP_MaterialShaderSettings]'.
+//Changing it affects which shaders are cached, so Materials recompile afterwards.
+UCLASS(Config=ExtendedGraphicsProgramming, DefaultConfig)
+class EXTENDEDGRAPHICSPROGRAMMING_API U_EGP_MaterialShaderSettings : public UObject
+{
+	GENERATED_BODY()
+public:
+
+	//If false, every EGP shader compiles for every post-process Material (the original behavior).
+	UPROPERTY(EditAnywhere, Config)
+	bool FilterPermutations = false;
+
+	//The Blendable Locations opted into EGP, for shader types without their own rule.
+	UPROPERTY(EditAnywhere, Config, meta=(EditCondition=FilterPermutations))
+	TArray<TEnumAsByte<EBlendableLocation>> DefaultBlendableLocations;
+
+	//Per-shader-type overrides of 'DefaultBlendableLocations'.
+	UPROPERTY(EditAnywhere, Config, meta=(EditCondition=FilterPermutations))
+	TArray<F_EGP_MaterialShaderPermutationRule> ShaderTypeRules;
+
+
+	//Whether the given shader type should compile for a Material with the given parameters.
+	//Pass a null type name to use the default rule.
+	bool ShouldCompileFor(const FMaterialShaderParameters& material, const TCHAR* shaderType) const;
+	//Whether any shader type's rule allows the given Material.
+	//Used by shaders that are paired with many others, like 'EGP::FScreenSpaceRenderVS'.
+	bool ShouldAnyCompileFor(const FMaterialShaderParameters& material) const;
+};
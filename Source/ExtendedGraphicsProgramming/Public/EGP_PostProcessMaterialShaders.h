@@ -30,12 +30,54 @@
 //First define Simulation passes:
 namespace EGP
 {
+	//What a Material pass should do if its shaders aren't available for the given Material
+	//    (usually because they haven't finished compiling yet).
+	enum class EMissingShaderPolicy : uint8
+	{
+		//Assert. Good for catching problems during development.
+		Crash,
+		//Skip the pass, making the 'Add[X]Pass()' function return false.
+		Skip,
+		//Use 'FMissingShaderSettings::FallbackMaterial' instead,
+		//    or skip the pass if that doesn't have its shaders either.
+		UseFallbackMaterial
+	};
+	struct FMissingShaderSettings
+	{
+		EMissingShaderPolicy Policy = EMissingShaderPolicy::Crash;
+		//Should be a Material whose shaders are known to be precompiled.
+		//If null, the engine's default post-process Material is used.
+		const UMaterialInterface* FallbackMaterial = nullptr;
+	};
+
+	//Private stuff
+	namespace impl
+	{
+		//Finds the shaders for a Material pass, following the given settings if they aren't available.
+		//Returns null if the pass should be skipped.
+		EXTENDEDGRAPHICSPROGRAMMING_API TOptional<FShaderMapFindResult> FindMaterialPassShaders_RenderThread(
+			const UMaterialInterface* material,
+			const FMaterialShaderTypes& shaderTypes,
+			ERHIFeatureLevel::Type featureLevel,
+			const FMissingShaderSettings& settings
+		);
+
+		//Runs the given lambda under the "EGP Material Passes" GPU stat, returning its result.
+		//The engine's GPU stats can't be referenced from other modules, so templates go through this.
+		EXTENDEDGRAPHICSPROGRAMMING_API bool AddMaterialPassWithGPUStat(FRDGBuilder& renderGraph,
+																		TFunctionRef<bool()> addPass);
+	}
+
 	//The base class for shaders that run Simulation passes.
 	struct EXTENDEDGRAPHICSPROGRAMMING_API FSimulationShader : public FMaterialShader
 	{
 		using FMaterialShader::FMaterialShader;
 		static void ModifyCompilationEnvironment(const FMaterialShaderPermutationParameters&, FShaderCompilerEnvironment&);
+		//Follows the default rule in 'U_EGP_MaterialShaderSettings'.
 		static bool ShouldCompilePermutation(const FMaterialShaderPermutationParameters&);
+		//Follows the rule configured for the given shader type in 'U_EGP_MaterialShaderSettings'.
+		//Call it from your own 'ShouldCompilePermutation()' to give your shader its own rule.
+		static bool ShouldCompilePermutationFor(const FMaterialShaderPermutationParameters&, const TCHAR* shaderType);
 		void SetParameters(FRHIBatchedShaderParameters&, const FMaterialRenderProxy*, const FMaterial&, const FViewInfo&);
 	};
 	
@@ -68,6 +110,9 @@ namespace EGP
 
 		bool UseAsyncCompute = false;
 
+		//What to do if the Material's shaders aren't ready.
+		FMissingShaderSettings MissingShaders;
+
 
 		FSimulationPassState() { }
 		
@@ -131,7 +176,8 @@ namespace EGP
 		EXTENDEDGRAPHICSPROGRAMMING_API void FillSimulationMaterialParams(
 			FRDGBuilder& renderGraph,
 			FSimulationMaterialParameters* params,
-			const FMaterial* material,
+			//From 'FShaderMapFindResult::UsedPostProcessInputs'; unused inputs get a dummy texture.
+			uint32 usedPostProcessInputs,
 			const FSimulationPassMaterialInputs& inputs
 		);
 	}
@@ -141,8 +187,10 @@ namespace EGP
 	//
 	//Your shader parameter struct must contain `EGP_SIMULATION_PASS_MATERIAL_DATA()`,
 	//    and its contents will be filled in by this function.
+	//
+	//Returns false if the pass was skipped because its shaders weren't available (see 'FMissingShaderSettings').
 	template<typename TComputeShader, typename TPassParams, typename SetupFn>
-	void AddSimulationMaterialPass(FRDGBuilder& renderGraph, FRDGEventName&& event,
+	bool AddSimulationMaterialPass(FRDGBuilder& renderGraph, FRDGEventName&& event,
 								   ERHIFeatureLevel::Type featureLevel,
 								   const UMaterialInterface* material,
 								   const FSimulationPassMaterialInputs& inputs,
@@ -156,84 +204,90 @@ namespace EGP
 		//Compile the shaders against the Material.
 		FMaterialShaderTypes types;
 		types.AddShaderType<TComputeShader>(state.PermutationID);
-		auto foundShaders = EGP::FindMaterialShaders_RenderThread(
-			material, types,
-			{ MD_PostProcess, featureLevel }
-		);
-		check(foundShaders);
+		auto foundShaders = impl::FindMaterialPassShaders_RenderThread(material, types, featureLevel, state.MissingShaders);
+		if (!foundShaders)
+			return false;
 
 		//Extract the shader and material proxy.
 		auto* materialProxy = foundShaders->MaterialProxy;
 		auto* materialF = foundShaders->Material;
 		TShaderRef<TComputeShader> shaderC;
-		ensure(foundShaders->Shaders.TryGetComputeShader(shaderC));
-
-		//Run the pass.
-		impl::FillSimulationMaterialParams(renderGraph, &paramStruct->SimulationPassData, materialF, inputs);
-		auto setupCallback = state.SetupCallback;
-		ERDGPassFlags flags = state.UseAsyncCompute ? ERDGPassFlags::AsyncCompute : ERDGPassFlags::Compute;
-		const decltype(FSimulationPassState::GroupCount)& groupCount = state.GroupCount; //Avoid dependent template BS
-		//The usual helper function for compute dispatch, FComputeShaderUtils::AddPass,
-		//    is made for Global shaders and does not handle Material shaders correctly.
-		//Therefore we have to do it all manually :(
-		if (groupCount.IsType<FIntVector3>())
+		if (!ensure(foundShaders->Shaders.TryGetComputeShader(shaderC)))
+			return false;
+
+		//Run the pass, under EGP's GPU stat.
+		return impl::AddMaterialPassWithGPUStat(renderGraph, [&]() -> bool
 		{
-			auto gc = groupCount.Get<FIntVector3>();
-			renderGraph.AddPass(MoveTemp(event), paramStruct, flags,
-							    [gc, shaderC, materialF, materialProxy,
-							    			   setupCallback = MoveTemp(setupCallback)]
-									(FRHICommandList& cmds) {
-				FRHIComputeShader* shaderRHI = shaderC.GetComputeShader();
-				SetComputePipelineState(cmds, shaderRHI);
+			impl::FillSimulationMaterialParams(renderGraph, &paramStruct->SimulationPassData,
+											   foundShaders->UsedPostProcessInputs, inputs);
+			auto setupCallback = state.SetupCallback;
+			ERDGPassFlags flags = state.UseAsyncCompute ? ERDGPassFlags::AsyncCompute : ERDGPassFlags::Compute;
+			const decltype(FSimulationPassState::GroupCount)& groupCount = state.GroupCount; //Avoid dependent template BS
+			//The usual helper function for compute dispatch, FComputeShaderUtils::AddPass,
+			//    is made for Global shaders and does not handle Material shaders correctly.
+			//Therefore we have to do it all manually :(
+			if (groupCount.IsType<FIntVector3>())
+			{
+				auto gc = groupCount.Get<FIntVector3>();
+				renderGraph.AddPass(MoveTemp(event), paramStruct, flags,
+								    [gc, shaderC, materialF, materialProxy,
+								    			   setupCallback = MoveTemp(setupCallback)]
+										(FRHICommandList& cmds) {
+					FRHIComputeShader* shaderRHI = shaderC.GetComputeShader();
+					SetComputePipelineState(cmds, shaderRHI);
 							    	
-				setupCallback(gc, cmds, shaderC, materialProxy, materialF);
-				cmds.DispatchComputeShader(gc.X, gc.Y, gc.Z);
-				UnsetShaderUAVs(cmds, shaderC, shaderRHI);
-		    });
-		}
-		else if (groupCount.IsType<TTuple<FRDGBufferRef, uint32>>())
-		{
-			auto indirectArgs = groupCount.Get<TTuple<FRDGBufferRef, uint32>>();
-			renderGraph.AddPass(MoveTemp(event), paramStruct, flags,
-							    [indirectArgs, shaderC, materialF, materialProxy,
-							    		       setupCallback = MoveTemp(setupCallback)]
-									(FRHICommandList& cmds) {
-				//The RDG doesn't know that we truly use the indirect dispatch buffer
-				//    because it gets sent directly into a command-list,
-				//    so we need to tell it we do to avoid warnings (and possibly out-of-order scheduling?).
-				indirectArgs.Key->MarkResourceAsUsed();
-				FComputeShaderUtils::ValidateIndirectArgsBuffer(indirectArgs.Key, indirectArgs.Value);
+					setupCallback(gc, cmds, shaderC, materialProxy, materialF);
+					cmds.DispatchComputeShader(gc.X, gc.Y, gc.Z);
+					UnsetShaderUAVs(cmds, shaderC, shaderRHI);
+			    });
+			}
+			else if (groupCount.IsType<TTuple<FRDGBufferRef, uint32>>())
+			{
+				auto indirectArgs = groupCount.Get<TTuple<FRDGBufferRef, uint32>>();
+				renderGraph.AddPass(MoveTemp(event), paramStruct, flags,
+								    [indirectArgs, shaderC, materialF, materialProxy,
+								    		       setupCallback = MoveTemp(setupCallback)]
+										(FRHICommandList& cmds) {
+					//The RDG doesn't know that we truly use the indirect dispatch buffer
+					//    because it gets sent directly into a command-list,
+					//    so we need to tell it we do to avoid warnings (and possibly out-of-order scheduling?).
+					indirectArgs.Key->MarkResourceAsUsed();
+					FComputeShaderUtils::ValidateIndirectArgsBuffer(indirectArgs.Key, indirectArgs.Value);
 							    	
-				FRHIComputeShader* shaderRHI = shaderC.GetComputeShader();
-				SetComputePipelineState(cmds, shaderRHI);
+					FRHIComputeShader* shaderRHI = shaderC.GetComputeShader();
+					SetComputePipelineState(cmds, shaderRHI);
 							    	
-				setupCallback(NullOpt, cmds, shaderC, materialProxy, materialF);
-				cmds.DispatchIndirectComputeShader(indirectArgs.Key->GetIndirectRHICallBuffer(), indirectArgs.Value);
-				UnsetShaderUAVs(cmds, shaderC, shaderRHI);
-		    });
-		}
-		else if (groupCount.IsType<FRDGDispatchGroupCountCallback*>())
-		{
-			auto groupCountLambda = MoveTemp(*groupCount.Get<FRDGDispatchGroupCountCallback*>());
-			renderGraph.AddPass(MoveTemp(event), paramStruct, flags,
-							    [groupCountLambda = MoveTemp(groupCountLambda),
-							    			   shaderC, materialF, materialProxy,
-							    			   setupCallback = MoveTemp(setupCallback)]
-							        (FRHICommandList& cmds) {
-				FRHIComputeShader* shaderRHI = shaderC.GetComputeShader();
-				SetComputePipelineState(cmds, shaderRHI);
-
-				FIntVector3 groupCount = groupCountLambda();
-				setupCallback(groupCount, cmds, shaderC, materialProxy, materialF);
-				cmds.DispatchComputeShader(groupCount.X, groupCount.Y, groupCount.Z);
-				UnsetShaderUAVs(cmds, shaderC, shaderRHI);
-		    });
-		}
-		else
-		{
-			//Unhandled case!
-			check(false);
-		}
+					setupCallback(NullOpt, cmds, shaderC, materialProxy, materialF);
+					cmds.DispatchIndirectComputeShader(indirectArgs.Key->GetIndirectRHICallBuffer(), indirectArgs.Value);
+					UnsetShaderUAVs(cmds, shaderC, shaderRHI);
+			    });
+			}
+			else if (groupCount.IsType<FRDGDispatchGroupCountCallback*>())
+			{
+				auto groupCountLambda = MoveTemp(*groupCount.Get<FRDGDispatchGroupCountCallback*>());
+				renderGraph.AddPass(MoveTemp(event), paramStruct, flags,
+								    [groupCountLambda = MoveTemp(groupCountLambda),
+								    			   shaderC, materialF, materialProxy,
+								    			   setupCallback = MoveTemp(setupCallback)]
+								        (FRHICommandList& cmds) {
+					FRHIComputeShader* shaderRHI = shaderC.GetComputeShader();
+					SetComputePipelineState(cmds, shaderRHI);
+
+					FIntVector3 groupCount = groupCountLambda();
+					setupCallback(groupCount, cmds, shaderC, materialProxy, materialF);
+					cmds.DispatchComputeShader(groupCount.X, groupCount.Y, groupCount.Z);
+					UnsetShaderUAVs(cmds, shaderC, shaderRHI);
+			    });
+			}
+			else
+			{
+				//Unhandled case!
+				check(false);
+				return false;
+			}
+
+			return true;
+		});
 	}
 	//Executes a compute Material Shader using the given Material.
 	//
@@ -242,8 +296,10 @@ namespace EGP
 	//
 	//While a Simulation pass doesn't conceptually have an associated View,
 	//    unfortunately it appears that Material shaders *need* to refer to one when setting parameters.
+	//
+	//Returns false if the pass was skipped because its shaders weren't available (see 'FMissingShaderSettings').
 	template<typename TComputeShader, typename TPassParams>
-	void AddSimulationMaterialPass(FRDGBuilder& renderGraph, FRDGEventName&& event,
+	bool AddSimulationMaterialPass(FRDGBuilder& renderGraph, FRDGEventName&& event,
 								   const FSimulationPassMaterialInputs& inputs,
 								   const FSimulationPassState& state,
 								   const FViewInfo& view,
@@ -261,13 +317,15 @@ namespace EGP
 									   matProxy, *mat, view);
 		};
 		
-		AddSimulationMaterialPass<TComputeShader, TPassParams, decltype(defaultSetupFn)>(
+		TSimulationPassState<decltype(defaultSetupFn)> fullState{
+			MoveTemp(defaultSetupFn),
+			state.GroupCount, state.PermutationID, state.UseAsyncCompute
+		};
+		fullState.MissingShaders = state.MissingShaders;
+
+		return AddSimulationMaterialPass<TComputeShader, TPassParams, decltype(defaultSetupFn)>(
 			renderGraph, MoveTemp(event), view.FeatureLevel,
-			material, inputs,
-			TSimulationPassState<decltype(defaultSetupFn)>{
-				MoveTemp(defaultSetupFn),
-				state.GroupCount, state.PermutationID, state.UseAsyncCompute
-			},
+			material, inputs, fullState,
 			paramStruct
 		);
 	}
@@ -281,7 +339,11 @@ namespace EGP
 	{
 		using FMaterialShader::FMaterialShader;
 		static void ModifyCompilationEnvironment(const FMaterialShaderPermutationParameters&, FShaderCompilerEnvironment&);
+		//Follows the default rule in 'U_EGP_MaterialShaderSettings'.
 		static bool ShouldCompilePermutation(const FMaterialShaderPermutationParameters&);
+		//Follows the rule configured for the given shader type in 'U_EGP_MaterialShaderSettings'.
+		//Call it from your own 'ShouldCompilePermutation()' to give your shader its own rule.
+		static bool ShouldCompilePermutationFor(const FMaterialShaderPermutationParameters&, const TCHAR* shaderType);
 		void SetParameters(FRHIBatchedShaderParameters&, const FMaterialRenderProxy*, const FMaterial&, const FViewInfo&);
 	};
 	
@@ -297,6 +359,15 @@ namespace EGP
 
 		//Informs the Material how to compute UV's correctly in various operations.
     	FScreenPassTextureViewport InputViewportData, OutputViewportData;
+		//If set, the output viewport is a half-width checkerboard of the full one (see 'EGP_ReducedRatePass.h'):
+		//    each output pixel stands for one of two horizontally-adjacent pixels, alternating every row.
+		//The value is the parity of that alternation.
+		TOptional<uint32> OutputCheckerboardParity;
+		//If true, the Material sees SV_Position in the view's own pixels rather than the output's,
+		//    keeping screen-position and world-position math correct when the output doesn't match the view rect
+		//    (e.g. a reduced-resolution target).
+		//Off by default, where SV_Position is the output pixel as usual.
+		bool RemapSvPositionToView = false;
 
 		const FViewInfo* TargetView = nullptr;
     };
@@ -314,13 +385,15 @@ namespace EGP
 			SHADER_PARAMETER_STRUCT_REF(FViewUniformShaderParameters, View)
 			SHADER_PARAMETER_STRUCT_INCLUDE(FSceneTextureShaderParameters, SceneTextures)
 			SHADER_PARAMETER_STRUCT(FScreenPassTextureViewportParameters, PostProcessOutput)
+			SHADER_PARAMETER(FUintVector2, OutputCheckerboard)
+			SHADER_PARAMETER(uint32, RemapSvPositionToView)
 			SHADER_PARAMETER_RDG_BUFFER_SRV(StructuredBuffer<float4>, EyeAdaptationBuffer)
 		END_SHADER_PARAMETER_STRUCT()
 
 		EXTENDEDGRAPHICSPROGRAMMING_API void FillScreenSpaceMaterialParams(
 			FRDGBuilder& renderGraph,
 			FScreenSpaceMaterialParameters* params,
-			const FMaterial* material,
+			uint32 usedPostProcessInputs,
 			const FScreenSpacePassMaterialInputs& inputs
 		);
 	}
@@ -351,6 +424,9 @@ namespace EGP
 
 		int PermutationIdVS = 0,
 			PermutationIdPS = 0;
+
+		//What to do if the Material's shaders aren't ready.
+		FMissingShaderSettings MissingShaders;
 	};
 	
 	//Instructions for how a screen-space Material pass should render itself, using a Vertex and Pixel shader.
@@ -374,7 +450,12 @@ namespace EGP
 								    FRHIDepthStencilState* depthStencilState = nullptr,
 								    uint_UnrealScreenPassStencil_t stencilRef = 0,
 								    int permutationIdVS = 0, int permutationIdPS = 0)
-			: FScreenSpacePassRenderState{ blendState, depthStencilState, stencilRef, permutationIdVS, permutationIdPS },
+			//Null states mean the defaults.
+			: FScreenSpacePassRenderState{
+				  (blendState != nullptr) ? blendState : FScreenPassPipelineState::FDefaultBlendState::GetRHI(),
+				  (depthStencilState != nullptr) ? depthStencilState : FScreenPassPipelineState::FDefaultDepthStencilState::GetRHI(),
+				  stencilRef, permutationIdVS, permutationIdPS
+			  },
 			  SetupCallback(MoveTemp(setupCallback))
 		{
 			
@@ -386,6 +467,9 @@ namespace EGP
 	//
 	//By default, parameter setup will be done automatically by calling SetShaderParametersMixedCS(...).
 	//If you instead want to provide a lambda for parameter setup, use the child struct TScreenSpacePassComputeState.
+	//
+	//Set 'UseAsyncCompute' to run on the async-compute pipe; to give it graphics work to overlap with,
+	//    add it early in the frame (see 'F_EGP_RenderPassSceneViewExtension::ComputeScheduling').
 	using FScreenSpacePassComputeState = FSimulationPassState;
 	
 	//Instructions for how a screen-space Material pass should execute, using a Compute shader.
@@ -402,6 +486,9 @@ namespace EGP
     public:
     	DECLARE_SHADER_TYPE(FScreenSpaceRenderVS, Material);
 
+    	//Compiles for any Material that some EGP shader type is allowed to use, since it's paired with all of them.
+    	static bool ShouldCompilePermutation(const FMaterialShaderPermutationParameters&);
+
     	using FParameters = impl::FScreenSpaceMaterialParameters;
     	SHADER_USE_PARAMETER_STRUCT_WITH_LEGACY_BASE(FScreenSpaceRenderVS, FScreenSpaceShader);
     };
@@ -413,8 +500,10 @@ namespace EGP
 	//    you are responsible for that if it's something you care about.
 	//
 	//See `AddPostProcessMaterialPass()` for sample engine code.
+	//
+	//Returns false if the pass was skipped because its shaders weren't available (see 'FMissingShaderSettings').
 	template<typename TVertexShader, typename TPixelShader, typename TPassParams, typename SetupFn>
-	void AddScreenSpaceRenderPass(FRDGBuilder& renderGraph, FRDGEventName&& event,
+	bool AddScreenSpaceRenderPass(FRDGBuilder& renderGraph, FRDGEventName&& event,
 								  const FScreenSpacePassMaterialInputs& inputs,
 								  const TScreenSpacePassRenderState<SetupFn>& state,
 								  TPassParams* paramStruct,
@@ -431,42 +520,50 @@ namespace EGP
 		FMaterialShaderTypes types;
 		types.AddShaderType<TVertexShader>(state.PermutationIdVS);
 		types.AddShaderType<TPixelShader>(state.PermutationIdPS);
-		auto foundShaders = EGP::FindMaterialShaders_RenderThread(
-			material, types,
-			{ MD_PostProcess, inputs.TargetView->FeatureLevel }
-		);
-		check(foundShaders);
+		auto foundShaders = impl::FindMaterialPassShaders_RenderThread(material, types,
+																	   inputs.TargetView->FeatureLevel,
+																	   state.MissingShaders);
+		if (!foundShaders)
+			return false;
 
 		//Extract the shaders and material proxy.
 		auto* materialProxy = foundShaders->MaterialProxy;
 		auto* materialF = foundShaders->Material;
 		TShaderRef<TVertexShader> shaderV;
 		TShaderRef<TPixelShader> shaderP;
-		ensure(foundShaders->Shaders.TryGetVertexShader(shaderV) &&
-			   foundShaders->Shaders.TryGetPixelShader(shaderP));
-
-		//Run the pass.
-		impl::FillScreenSpaceMaterialParams(renderGraph, &paramStruct->ScreenSpacePassData,
-										    materialF, inputs);
-		auto setupLambda = state.SetupCallback;
-		auto& view = *inputs.TargetView;
-		AddDrawScreenPass(
-			renderGraph, MoveTemp(event),
-			FScreenPassViewInfo{ *inputs.TargetView },
-			inputs.OutputViewportData,
-			inputs.InputViewportData,
-			FScreenPassPipelineState{
-				shaderV, shaderP,
-				state.BlendState, state.DepthStencilState, state.StencilRef
-			},
-			paramStruct,
-			EScreenPassDrawFlags::AllowHMDHiddenAreaMask,
-			[materialProxy, materialF, &view, shaderV, shaderP, setupLambda = MoveTemp(setupLambda)]
-				(FRHICommandList& cmds)
-			{
-				setupLambda(cmds, shaderV, shaderP, materialProxy, materialF, view);
-			}
-		);
+		if (!ensure(foundShaders->Shaders.TryGetVertexShader(shaderV) &&
+					foundShaders->Shaders.TryGetPixelShader(shaderP)))
+		{
+			return false;
+		}
+
+		//Run the pass, under EGP's GPU stat.
+		return impl::AddMaterialPassWithGPUStat(renderGraph, [&]() -> bool
+		{
+			impl::FillScreenSpaceMaterialParams(renderGraph, &paramStruct->ScreenSpacePassData,
+											    foundShaders->UsedPostProcessInputs, inputs);
+			auto setupLambda = state.SetupCallback;
+			auto& view = *inputs.TargetView;
+			AddDrawScreenPass(
+				renderGraph, MoveTemp(event),
+				FScreenPassViewInfo{ *inputs.TargetView },
+				inputs.OutputViewportData,
+				inputs.InputViewportData,
+				FScreenPassPipelineState{
+					shaderV, shaderP,
+					state.BlendState, state.DepthStencilState, state.StencilRef
+				},
+				paramStruct,
+				EScreenPassDrawFlags::AllowHMDHiddenAreaMask,
+				[materialProxy, materialF, &view, shaderV, shaderP, setupLambda = MoveTemp(setupLambda)]
+					(FRHICommandList& cmds)
+				{
+					setupLambda(cmds, shaderV, shaderP, materialProxy, materialF, view);
+				}
+			);
+
+			return true;
+		});
 	}
 	//Sets up a Screen-Space render pass, with a vertex and pixel shader using a post-process Material.
 	//In most cases you can use 'EGP::FScreenSpaceRenderVS' for your vertex shader.
@@ -480,8 +577,10 @@ namespace EGP
 	//    you are responsible for that if it's something you care about.
 	//
 	//See `AddPostProcessMaterialPass()` for sample engine code.
+	//
+	//Returns false if the pass was skipped because its shaders weren't available (see 'FMissingShaderSettings').
 	template<typename TVertexShader, typename TPixelShader, typename TPassParams>
-	void AddScreenSpaceRenderPass(FRDGBuilder& renderGraph, FRDGEventName&& event,
+	bool AddScreenSpaceRenderPass(FRDGBuilder& renderGraph, FRDGEventName&& event,
 								  const FScreenSpacePassMaterialInputs& inputs,
 								  const FScreenSpacePassRenderState& state,
 								  TPassParams* paramStruct,
@@ -500,20 +599,154 @@ namespace EGP
 			SetShaderParametersMixedPS(cmds, shaderP, *paramStructInnerPS, matProxy, *mat, view);
 		};
 
-		AddScreenSpaceRenderPass<TVertexShader, TPixelShader, TPassParams, decltype(defaultSetupFn)>(
-			renderGraph, MoveTemp(event), inputs,
-			TScreenSpacePassRenderState<decltype(defaultSetupFn)>{
-				MoveTemp(defaultSetupFn),
-				state.BlendState, state.DepthStencilState, state.StencilRef,
-				state.PermutationIdVS, state.PermutationIdPS
-			},
+		TScreenSpacePassRenderState<decltype(defaultSetupFn)> fullState{
+			MoveTemp(defaultSetupFn),
+			state.BlendState, state.DepthStencilState, state.StencilRef,
+			state.PermutationIdVS, state.PermutationIdPS
+		};
+		fullState.MissingShaders = state.MissingShaders;
+
+		return AddScreenSpaceRenderPass<TVertexShader, TPixelShader, TPassParams, decltype(defaultSetupFn)>(
+			renderGraph, MoveTemp(event), inputs, fullState,
 			paramStruct, material
 		);
 	}
 
+	//Private stuff.
+	namespace impl
+	{
+		//Makes subsequent passes draw on top of the targets' current contents,
+		//    which lets the RDG merge them into the previous render pass.
+		EXTENDEDGRAPHICSPROGRAMMING_API void SwitchToLoadActions(FRenderTargetBindingSlots& targets);
+	}
+
+	//One Material "layer" in a batch of screen-space render passes (see 'AddScreenSpaceRenderPasses()').
+	template<typename TVertexShader, typename TPixelShader, typename TPassParams>
+	struct TScreenSpacePassBatchEntry
+	{
+		const UMaterialInterface* Material = nullptr;
+		FScreenSpacePassRenderState State;
+		//If set, overrides the batch's inputs for this entry;
+		//    e.g. one entry per view of a family, for views that share the same target(s).
+		const FScreenSpacePassMaterialInputs* Inputs = nullptr;
+
+		//Like any RDG pass, each entry needs its own parameter struct allocated from the graph.
+		//Its render targets will be filled in for you.
+		TPassParams* Params = nullptr;
+		typename TVertexShader::FParameters* ParamsVS = nullptr;
+		typename TPixelShader::FParameters* ParamsPS = nullptr;
+	};
+
+	//Draws a sequence of post-process Materials into the same render target(s), one after another
+	//    (for example, layered stylization effects).
+	//It also covers every view of a family drawing into a shared target (e.g. split-screen or stereo):
+	//    give each view its own entry with its own 'Inputs'.
+	//Each view is still its own draw: Material shaders read the post-process input viewports as shader constants,
+	//    so a single instanced draw can't give every view its own.
+	//Your parameter struct must contain 'RENDER_TARGET_BINDING_SLOTS()'.
+	//
+	//After the first entry is drawn, the targets are switched to 'ERenderTargetLoadAction::ELoad'
+	//    so that the RDG merges every entry into a single render pass,
+	//    avoiding the load/store traffic between them.
+	//The Material lookups, dummy textures, and view resources are also shared across entries.
+	//
+	//Returns the number of entries that were drawn; entries can be skipped if their shaders aren't available.
+	template<typename TVertexShader, typename TPixelShader, typename TPassParams>
+	int32 AddScreenSpaceRenderPasses(FRDGBuilder& renderGraph, const TCHAR* batchName,
+									 const FScreenSpacePassMaterialInputs& inputs,
+									 const FRenderTargetBindingSlots& renderTargets,
+									 TArrayView<const TScreenSpacePassBatchEntry<TVertexShader, TPixelShader, TPassParams>> entries)
+	{
+		check(IsInRenderingThread());
+		RDG_EVENT_SCOPE(renderGraph, "%s", batchName);
+
+		FRenderTargetBindingSlots targets = renderTargets;
+		int32 nDrawn = 0;
+		for (const auto& entry : entries)
+		{
+			entry.Params->RenderTargets = targets;
+			bool drawn = AddScreenSpaceRenderPass<TVertexShader, TPixelShader, TPassParams>(
+				renderGraph, RDG_EVENT_NAME("%s", *GetNameSafe(entry.Material)),
+				(entry.Inputs != nullptr) ? *entry.Inputs : inputs,
+				entry.State, entry.Params, entry.Material,
+				entry.ParamsVS, entry.ParamsPS
+			);
+			if (!drawn)
+				continue;
+			nDrawn += 1;
+
+			//Subsequent entries draw on top of this one.
+			if (nDrawn == 1)
+				impl::SwitchToLoadActions(targets);
+		}
+
+		return nDrawn;
+	}
+
+	//The render targets a screen-space render pass will draw into,
+	//    needed to precompile its pipeline state ahead of time.
+	struct FScreenSpacePassTargetFormats
+	{
+		TArray<EPixelFormat, TInlineAllocator<MaxSimultaneousRenderTargets>> ColorFormats;
+		ETextureCreateFlags ColorFlags = TexCreate_RenderTargetable | TexCreate_ShaderResource;
+		EPixelFormat DepthStencilFormat = PF_Unknown;
+		ETextureCreateFlags DepthStencilFlags = TexCreate_DepthStencilTargetable | TexCreate_ShaderResource;
+		uint16 NumSamples = 1;
+	};
+
+	//Private stuff.
+	namespace impl
+	{
+		//Returns false if PSO precaching is disabled or the targets are invalid.
+		EXTENDEDGRAPHICSPROGRAMMING_API bool PrecacheScreenSpacePipeline_RenderThread(
+			FRHIVertexShader* shaderV, FRHIPixelShader* shaderP,
+			const FScreenSpacePassRenderState& state,
+			const FScreenSpacePassTargetFormats& targets
+		);
+	}
+
+	//Compiles the pipeline state for a future 'AddScreenSpaceRenderPass()' call ahead of time,
+	//    so its first use doesn't stall on a PSO compile (mostly relevant on DX12 and Vulkan).
+	//Call it when your pass is created or when its Material is loaded,
+	//    for each combination of Material, render state, and target formats you'll use.
+	//
+	//Null blend and depth-stencil states mean the same defaults as the pass itself.
+	//Returns false if the shaders aren't available yet, PSO precaching is disabled,
+	//    or there are more color formats than 'MaxSimultaneousRenderTargets'.
+	template<typename TVertexShader, typename TPixelShader>
+	bool PrecacheScreenSpaceRenderPass_RenderThread(const UMaterialInterface* material,
+													ERHIFeatureLevel::Type featureLevel,
+													const FScreenSpacePassRenderState& state,
+													const FScreenSpacePassTargetFormats& targets)
+	{
+		check(IsInRenderingThread());
+
+		FMaterialShaderTypes types;
+		types.AddShaderType<TVertexShader>(state.PermutationIdVS);
+		types.AddShaderType<TPixelShader>(state.PermutationIdPS);
+		if (!PrecacheMaterialShaders_RenderThread(material, types, { MD_PostProcess, featureLevel }))
+			return false;
+
+		//The lookup is cached, so this second search is cheap.
+		auto foundShaders = FindMaterialShadersCached_RenderThread(material, types, { MD_PostProcess, featureLevel });
+		TShaderRef<TVertexShader> shaderV;
+		TShaderRef<TPixelShader> shaderP;
+		if (!foundShaders ||
+			!foundShaders->Shaders.TryGetVertexShader(shaderV) ||
+			!foundShaders->Shaders.TryGetPixelShader(shaderP))
+		{
+			return false;
+		}
+
+		return impl::PrecacheScreenSpacePipeline_RenderThread(shaderV.GetVertexShader(), shaderP.GetPixelShader(),
+															  state, targets);
+	}
+
 	//Sets up a screen-space compute pass, using a post-process Material and your compute shader.
+	//
+	//Returns false if the pass was skipped because its shaders weren't available (see 'FMissingShaderSettings').
 	template<typename TComputeShader, typename TPassParams, typename SetupFn>
-	void AddScreenSpaceComputePass(FRDGBuilder& renderGraph, FRDGEventName&& event,
+	bool AddScreenSpaceComputePass(FRDGBuilder& renderGraph, FRDGEventName&& event,
 								   const FScreenSpacePassMaterialInputs& inputs,
 								   const TScreenSpacePassComputeState<SetupFn>& state,
 								   TPassParams* paramStruct, const UMaterialInterface* material)
@@ -527,94 +760,105 @@ namespace EGP
 		//Compile the shaders against the Material.
 		FMaterialShaderTypes types;
 		types.AddShaderType<TComputeShader>(state.PermutationID);
-		auto foundShaders = EGP::FindMaterialShaders_RenderThread(
-			material, types,
-			{ MD_PostProcess, inputs.TargetView->FeatureLevel }
-		);
-		check(foundShaders);
+		auto foundShaders = impl::FindMaterialPassShaders_RenderThread(material, types,
+																	   inputs.TargetView->FeatureLevel,
+																	   state.MissingShaders);
+		if (!foundShaders)
+			return false;
 
 		//Extract the shader and material proxy.
 		auto* materialProxy = foundShaders->MaterialProxy;
 		auto* materialF = foundShaders->Material;
 		TShaderRef<TComputeShader> shaderC;
-		ensure(foundShaders->Shaders.TryGetComputeShader(shaderC));
-
-		//Run the pass.
-		impl::FillScreenSpaceMaterialParams(renderGraph, &paramStruct->ScreenSpacePassData, materialF, inputs);
-		auto setupCallback = state.SetupCallback;
-		const auto& view = *inputs.TargetView;
-		ERDGPassFlags flags = state.UseAsyncCompute ? ERDGPassFlags::AsyncCompute : ERDGPassFlags::Compute;
-		//The usual helper function for compute dispatch, FComputeShaderUtils::AddPass,
-		//    is made for Global shaders and does not handle Material shaders correctly.
-		//Therefore we have to do it all manually :(
-		if (state.GroupCount.template IsType<FIntVector3>())
+		if (!ensure(foundShaders->Shaders.TryGetComputeShader(shaderC)))
+			return false;
+
+		//Run the pass, under EGP's GPU stat.
+		return impl::AddMaterialPassWithGPUStat(renderGraph, [&]() -> bool
 		{
-			auto groupCount = state.GroupCount.template Get<FIntVector3>();
-			renderGraph.AddPass(MoveTemp(event), paramStruct, flags,
-							    [groupCount, shaderC, materialF, materialProxy, &view,
-							    			   setupCallback = MoveTemp(setupCallback)]
-									(FRHICommandList& cmds) {
-				FRHIComputeShader* shaderRHI = shaderC.GetComputeShader();
-				SetComputePipelineState(cmds, shaderRHI);
+			impl::FillScreenSpaceMaterialParams(renderGraph, &paramStruct->ScreenSpacePassData,
+											    foundShaders->UsedPostProcessInputs, inputs);
+			auto setupCallback = state.SetupCallback;
+			const auto& view = *inputs.TargetView;
+			ERDGPassFlags flags = state.UseAsyncCompute ? ERDGPassFlags::AsyncCompute : ERDGPassFlags::Compute;
+			//The usual helper function for compute dispatch, FComputeShaderUtils::AddPass,
+			//    is made for Global shaders and does not handle Material shaders correctly.
+			//Therefore we have to do it all manually :(
+			if (state.GroupCount.template IsType<FIntVector3>())
+			{
+				auto groupCount = state.GroupCount.template Get<FIntVector3>();
+				renderGraph.AddPass(MoveTemp(event), paramStruct, flags,
+								    [groupCount, shaderC, materialF, materialProxy, &view,
+								    			   setupCallback = MoveTemp(setupCallback)]
+										(FRHICommandList& cmds) {
+					FRHIComputeShader* shaderRHI = shaderC.GetComputeShader();
+					SetComputePipelineState(cmds, shaderRHI);
 							    	
-				setupCallback(groupCount, cmds, shaderC, materialProxy, materialF, view);
-				cmds.DispatchComputeShader(groupCount.X, groupCount.Y, groupCount.Z);
-				UnsetShaderUAVs(cmds, shaderC, shaderRHI);
-		    });
-		}
-		else if (state.GroupCount.template IsType<TTuple<FRDGBufferRef, uint32>>())
-		{
-			auto indirectArgs = state.GroupCount.template Get<TTuple<FRDGBufferRef, uint32>>();
-			renderGraph.AddPass(MoveTemp(event), paramStruct, flags,
-							    [indirectArgs, shaderC, materialF, materialProxy, &view,
-							    		       setupCallback = MoveTemp(setupCallback)]
-									(FRHICommandList& cmds) {
-				//The RDG doesn't know that we truly use the indirect dispatch buffer
-				//    because it gets sent directly into a command-list,
-				//    so we need to explicitly tell it in order to avoid warnings (and possibly out-of-order scheduling?).
-				indirectArgs.Key->MarkResourceAsUsed();
-				FComputeShaderUtils::ValidateIndirectArgsBuffer(indirectArgs.Key, indirectArgs.Value);
+					setupCallback(groupCount, cmds, shaderC, materialProxy, materialF, view);
+					cmds.DispatchComputeShader(groupCount.X, groupCount.Y, groupCount.Z);
+					UnsetShaderUAVs(cmds, shaderC, shaderRHI);
+			    });
+			}
+			else if (state.GroupCount.template IsType<TTuple<FRDGBufferRef, uint32>>())
+			{
+				auto indirectArgs = state.GroupCount.template Get<TTuple<FRDGBufferRef, uint32>>();
+				renderGraph.AddPass(MoveTemp(event), paramStruct, flags,
+								    [indirectArgs, shaderC, materialF, materialProxy, &view,
+								    		       setupCallback = MoveTemp(setupCallback)]
+										(FRHICommandList& cmds) {
+					//The RDG doesn't know that we truly use the indirect dispatch buffer
+					//    because it gets sent directly into a command-list,
+					//    so we need to explicitly tell it in order to avoid warnings (and possibly out-of-order scheduling?).
+					indirectArgs.Key->MarkResourceAsUsed();
+					FComputeShaderUtils::ValidateIndirectArgsBuffer(indirectArgs.Key, indirectArgs.Value);
 							    	
-				FRHIComputeShader* shaderRHI = shaderC.GetComputeShader();
-				SetComputePipelineState(cmds, shaderRHI);
+					FRHIComputeShader* shaderRHI = shaderC.GetComputeShader();
+					SetComputePipelineState(cmds, shaderRHI);
 							    	
-				setupCallback(NullOpt, cmds, shaderC, materialProxy, materialF, view);
-				cmds.DispatchIndirectComputeShader(indirectArgs.Key->GetIndirectRHICallBuffer(), indirectArgs.Value);
-				UnsetShaderUAVs(cmds, shaderC, shaderRHI);
-		    });
-		}
-		else if (state.GroupCount.template IsType<FRDGDispatchGroupCountCallback*>())
-		{
-			auto groupCountLambda = MoveTemp(*state.GroupCount.template Get<FRDGDispatchGroupCountCallback*>());
-			renderGraph.AddPass(MoveTemp(event), paramStruct, flags,
-							    [groupCountLambda = MoveTemp(groupCountLambda),
-							    			   shaderC, materialF, materialProxy, &view,
-							    			   setupCallback = MoveTemp(setupCallback)]
-							        (FRHICommandList& cmds) {
-				FRHIComputeShader* shaderRHI = shaderC.GetComputeShader();
-				SetComputePipelineState(cmds, shaderRHI);
-
-				FIntVector3 groupCount = groupCountLambda();
-				setupCallback(groupCount, cmds, shaderC, materialProxy, materialF, view);
-				cmds.DispatchComputeShader(groupCount.X, groupCount.Y, groupCount.Z);
-				UnsetShaderUAVs(cmds, shaderC, shaderRHI);
-		    });
-		}
-		else
-		{
-			//Unhandled case!
-			check(false);
-		}
+					setupCallback(NullOpt, cmds, shaderC, materialProxy, materialF, view);
+					cmds.DispatchIndirectComputeShader(indirectArgs.Key->GetIndirectRHICallBuffer(), indirectArgs.Value);
+					UnsetShaderUAVs(cmds, shaderC, shaderRHI);
+			    });
+			}
+			else if (state.GroupCount.template IsType<FRDGDispatchGroupCountCallback*>())
+			{
+				auto groupCountLambda = MoveTemp(*state.GroupCount.template Get<FRDGDispatchGroupCountCallback*>());
+				renderGraph.AddPass(MoveTemp(event), paramStruct, flags,
+								    [groupCountLambda = MoveTemp(groupCountLambda),
+								    			   shaderC, materialF, materialProxy, &view,
+								    			   setupCallback = MoveTemp(setupCallback)]
+								        (FRHICommandList& cmds) {
+					FRHIComputeShader* shaderRHI = shaderC.GetComputeShader();
+					SetComputePipelineState(cmds, shaderRHI);
+
+					FIntVector3 groupCount = groupCountLambda();
+					setupCallback(groupCount, cmds, shaderC, materialProxy, materialF, view);
+					cmds.DispatchComputeShader(groupCount.X, groupCount.Y, groupCount.Z);
+					UnsetShaderUAVs(cmds, shaderC, shaderRHI);
+			    });
+			}
+			else
+			{
+				//Unhandled case!
+				check(false);
+				return false;
+			}
+
+			return true;
+		});
 	}
 	//Sets up a screen-space compute pass, using a post-process Material and your compute shader.
+	//
+	//Returns false if the pass was skipped because its shaders weren't available (see 'FMissingShaderSettings').
 	template<typename TComputeShader, typename TPassParams>
-	void AddScreenSpaceComputePass(FRDGBuilder& renderGraph, FRDGEventName&& event,
+	bool AddScreenSpaceComputePass(FRDGBuilder& renderGraph, FRDGEventName&& event,
 								   const FScreenSpacePassMaterialInputs& inputs,
 								   const FScreenSpacePassComputeState& state,
 								   TPassParams* paramStruct, const UMaterialInterface* material)
 	{
 		auto defaultSetupFn = [paramStruct]
-								 (FRHICommandList& cmds,
+								 (TOptional<FIntVector3> groupCountIfDirect,
+								  FRHICommandList& cmds,
 								  TShaderRef<TComputeShader> shaderC,
 								  const FMaterialRenderProxy* matProxy, const FMaterial* mat,
 								  const FViewInfo& view)
@@ -622,12 +866,14 @@ namespace EGP
 			SetShaderParametersMixedCS(cmds, shaderC, *paramStruct, matProxy, *mat, view);
 		};
 
-		AddScreenSpaceMaterialPass<TComputeShader, TPassParams, decltype(defaultSetupFn)>(
-			renderGraph, MoveTemp(event), inputs,
-			TScreenSpacePassComputeState<decltype(defaultSetupFn)>{
-				MoveTemp(defaultSetupFn),
-				state.GroupCount, state.PermutationID, state.UseAsyncCompute
-			},
+		TScreenSpacePassComputeState<decltype(defaultSetupFn)> fullState{
+			MoveTemp(defaultSetupFn),
+			state.GroupCount, state.PermutationID, state.UseAsyncCompute
+		};
+		fullState.MissingShaders = state.MissingShaders;
+
+		return AddScreenSpaceComputePass<TComputeShader, TPassParams, decltype(defaultSetupFn)>(
+			renderGraph, MoveTemp(event), inputs, fullState,
 			paramStruct, material
 		);
 	}
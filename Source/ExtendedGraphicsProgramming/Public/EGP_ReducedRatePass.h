@@ -0,0 +1,74 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+#include "EGP_PostProcessMaterialShaders.h"
+
+
+namespace EGP
+{
+	//How a reduced-rate screen-space pass covers the view.
+	enum class EReducedRateMode : uint8
+	{
+		//Renders one pixel for every 2x2 block.
+		Half,
+		//Renders every other pixel in a checkerboard pattern that flips each frame,
+		//    into a half-width texture.
+		Checkerboard
+	};
+
+	//A low-resolution target for a screen-space Material pass,
+	//    plus everything needed to upsample it back to the full view afterwards.
+	//Made by 'CreateReducedRateTarget()'.
+	struct FReducedRateTarget
+	{
+		EReducedRateMode Mode = EReducedRateMode::Half;
+
+		//Render your Material pass into this.
+		FScreenPassRenderTarget LowRes;
+
+		//The full-resolution depth that guides the upsample; its 'ViewRect' is the region being approximated.
+		FScreenPassTexture FullResDepth;
+		//The depth under each pixel of 'LowRes'. Only used in 'EReducedRateMode::Half'.
+		FScreenPassTexture LowResDepth;
+
+		//Which pixel of each horizontal pair was rendered, on even rows.
+		//Only used in 'EReducedRateMode::Checkerboard'.
+		uint32 CheckerboardParity = 0;
+
+		//Points a Material pass's output viewport at 'LowRes'.
+		void SetupInputs(FScreenSpacePassMaterialInputs& inputs) const
+		{
+			inputs.OutputViewportData = FScreenPassTextureViewport(LowRes);
+			inputs.RemapSvPositionToView = true;
+			if (Mode == EReducedRateMode::Checkerboard)
+				inputs.OutputCheckerboardParity = CheckerboardParity;
+			else
+				inputs.OutputCheckerboardParity.Reset();
+		}
+	};
+
+	//Allocates a reduced-rate target for the given region of scene depth (usually the view rect),
+	//    and (in 'EReducedRateMode::Half') downsamples the depth with 'AddDownsampleDepthPass()'.
+	//The target is usable as a render target or a UAV, so it works with render and compute Material passes.
+	EXTENDEDGRAPHICSPROGRAMMING_API FReducedRateTarget CreateReducedRateTarget(
+		FRDGBuilder& graph, const FViewInfo& view,
+		FScreenPassTexture sceneDepth,
+		EReducedRateMode mode, EPixelFormat format,
+		const TCHAR* debugName = TEXT("EGP.ReducedRate")
+	);
+
+	//Upsamples a reduced-rate target to full resolution with a depth-aware (bilateral) filter,
+	//    so that results don't bleed across depth edges.
+	//The output's view rect must be the same size as the target's full-resolution depth rect.
+	//
+	//A blend state can be given to composite the result directly onto e.g. scene color.
+	//Higher depth sensitivity keeps edges sharper, at the cost of more aliasing.
+	EXTENDEDGRAPHICSPROGRAMMING_API void AddReducedRateUpsamplePass(
+		FRDGBuilder& graph, const FViewInfo& view,
+		const FReducedRateTarget& source,
+		FScreenPassRenderTarget output,
+		FRHIBlendState* blendState = nullptr,
+		float depthSensitivity = 50.0f
+	);
+}
@@ -0,0 +1,195 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "RenderGraphUtils.h"
+
+#include "EGP_CustomRenderPasses.h"
+#include "EGP_PostProcessMaterialShaders.h"
+
+
+namespace EGP
+{
+	//Private stuff.
+	namespace impl
+	{
+		//Lets 'TSimulationState' treat textures and buffers the same way.
+		template<typename TDesc>
+		struct TSimulationStateTraits;
+
+		template<>
+		struct TSimulationStateTraits<FRDGTextureDesc>
+		{
+			using FPooled = TRefCountPtr<IPooledRenderTarget>;
+			using FRef = FRDGTextureRef;
+
+			static bool Matches(const FPooled& resource, const FRDGTextureDesc& desc) { return resource->GetDesc() == desc; }
+			static FRef Create(FRDGBuilder& graph, const FRDGTextureDesc& desc, const TCHAR* name,
+							   F_EGP_ViewResourcePool* pool, FPooled& outResource)
+			{
+				if (pool != nullptr)
+					return pool->CreateTexture(graph, desc, name, outResource);
+				outResource = AllocatePooledTexture(desc, name);
+				return graph.RegisterExternalTexture(outResource, name);
+			}
+			static FRef Register(FRDGBuilder& graph, const FPooled& resource, const TCHAR* name)
+			{
+				return graph.RegisterExternalTexture(resource, name);
+			}
+		};
+
+		template<>
+		struct TSimulationStateTraits<FRDGBufferDesc>
+		{
+			using FPooled = TRefCountPtr<FRDGPooledBuffer>;
+			using FRef = FRDGBufferRef;
+
+			static bool Matches(const FPooled& resource, const FRDGBufferDesc& desc) { return resource->Desc == desc; }
+			static FRef Create(FRDGBuilder& graph, const FRDGBufferDesc& desc, const TCHAR* name,
+							   F_EGP_ViewResourcePool* pool, FPooled& outResource)
+			{
+				if (pool != nullptr)
+					return pool->CreateBuffer(graph, desc, name, outResource);
+				outResource = AllocatePooledBuffer(desc, name);
+				return graph.RegisterExternalBuffer(outResource, name);
+			}
+			static FRef Register(FRDGBuilder& graph, const FPooled& resource, const TCHAR* name)
+			{
+				return graph.RegisterExternalBuffer(resource, name);
+			}
+		};
+	}
+
+	//The persistent state of a GPU simulation: several copies of one texture or buffer, rotated every frame,
+	//    so that each frame reads the previous frames' states and writes a new one.
+	//The copies are pooled resources owned by this object, so there's no need for ping-ponging,
+	//    extraction, or copies by hand.
+	//Render-thread only. Use 'FSimulationTextureState' or 'FSimulationBufferState'.
+	//
+	//For per-view simulations, put these in your 'F_EGP_ViewPersistentData' and pass the owner's 'ResourcePool' in,
+	//    then forward 'GetGPUByteSize()' and 'ReleaseResources()' to them.
+	template<typename TDesc>
+	class TSimulationState
+	{
+		using FTraits = impl::TSimulationStateTraits<TDesc>;
+
+	public:
+
+		using FPooled = typename FTraits::FPooled;
+		using FRef = typename FTraits::FRef;
+
+		//Two copies is a classic ping-pong; more let the simulation read further back in time.
+		explicit TSimulationState(int32 nCopies = 2)
+		{
+			check(nCopies >= 2);
+			copies.SetNum(nCopies);
+			refs.Init(nullptr, nCopies);
+		}
+
+		//Call once per frame, before adding any passes that use this state.
+		//Advances the history by one frame and registers every copy with the graph.
+		//
+		//If the description changed (or this is the first frame), all copies are reallocated
+		//    and 'HasHistory()' is false until the next frame.
+		//Give a resource pool to recycle memory between simulations (e.g. 'T_EGP_PerViewData::ResourcePool').
+		void BeginFrame(FRDGBuilder& graph, const TDesc& desc, const TCHAR* name,
+						F_EGP_ViewResourcePool* pool = nullptr)
+		{
+			check(IsInRenderingThread());
+
+			if (!copies[0].IsValid() || !FTraits::Matches(copies[0], desc))
+			{
+				ReleaseResources(pool);
+				for (int32 i = 0; i < copies.Num(); ++i)
+					refs[i] = FTraits::Create(graph, desc, name, pool, copies[i]);
+			}
+			else
+			{
+				current = (current + 1) % copies.Num();
+				nHistoryFrames = FMath::Min(nHistoryFrames + 1, copies.Num() - 1);
+				for (int32 i = 0; i < copies.Num(); ++i)
+					refs[i] = FTraits::Register(graph, copies[i], name);
+			}
+		}
+
+		//The state being written this frame.
+		//Like all RDG refs, it's only valid for the graph given to 'BeginFrame()'.
+		FRef GetCurrent() const { return refs[current]; }
+		//The state written the given number of frames ago (up to one less than the number of copies).
+		//Returned even if it was never written; check 'HasHistory()' first.
+		FRef GetPrevious(int32 framesAgo = 1) const
+		{
+			check(framesAgo > 0 && framesAgo < copies.Num());
+			return refs[(current + copies.Num() - framesAgo) % copies.Num()];
+		}
+		//Whether the state from the given number of frames ago was actually written.
+		bool HasHistory(int32 framesAgo = 1) const { return framesAgo <= nHistoryFrames; }
+
+		uint64 GetGPUByteSize() const
+		{
+			uint64 nBytes = 0;
+			for (const auto& copy : copies)
+				nBytes += F_EGP_ViewResourcePool::GetByteSize(copy);
+			return nBytes;
+		}
+		//Drops all copies, giving them to the pool if one is provided.
+		void ReleaseResources(F_EGP_ViewResourcePool* pool = nullptr)
+		{
+			for (auto& copy : copies)
+			{
+				if (pool != nullptr && copy.IsValid())
+					pool->Return(copy);
+				else
+					copy.SafeRelease();
+			}
+			refs.Init(nullptr, copies.Num());
+			current = 0;
+			nHistoryFrames = 0;
+		}
+
+	private:
+
+		TArray<FPooled, TInlineAllocator<2>> copies;
+		TArray<FRef, TInlineAllocator<2>> refs;
+		int32 current = 0,
+			  nHistoryFrames = 0;
+	};
+	using FSimulationTextureState = TSimulationState<FRDGTextureDesc>;
+	using FSimulationBufferState = TSimulationState<FRDGBufferDesc>;
+
+
+	//The active tiles of a simulation, compacted by 'AddSimulationActiveRegionsPass()'.
+	struct FSimulationActiveRegions
+	{
+		//The index of each active tile, packed together in no particular order (a 'Buffer<uint>').
+		FRDGBufferRef ActiveTiles = nullptr;
+		//The number of active tiles (a 'Buffer<uint>' with one element).
+		FRDGBufferRef ActiveCount = nullptr;
+		//Indirect args for a compute dispatch with 'groupsPerTile' groups per active tile.
+		//The groups are numbered along X, wrapping into Y every 'GroupsPerRow' groups
+		//    so that many active tiles don't exceed the per-dimension group limit.
+		FRDGBufferRef DispatchArgs = nullptr;
+
+		static constexpr uint32 GroupsPerRow = 65535;
+
+		//Makes a simulation pass dispatch over only the active tiles.
+		//Each group finds its index with 'groupIdx = GroupId.y * GroupsPerRow + GroupId.x',
+		//    exits if 'groupIdx >= ActiveCount[0] * groupsPerTile' (the last row overshoots),
+		//    and then finds its tile with 'ActiveTiles[groupIdx / groupsPerTile]'.
+		void SetupState(FSimulationPassState& state) const
+		{
+			state.GroupCount.Set<TTuple<FRDGBufferRef, uint32>>(MakeTuple(DispatchArgs, 0u));
+		}
+	};
+
+	//Compacts a simulation's per-tile activity flags into a list of active tiles plus indirect dispatch args,
+	//    so idle regions of the simulation cost nothing.
+	//'tileActivity' is a 'Buffer<uint>' with one element per tile, nonzero if the tile is active;
+	//    usually it's an 'FSimulationBufferState' written by the previous frame's simulation pass
+	//    (which should also activate the neighbors of any tile that might spread into them).
+	EXTENDEDGRAPHICSPROGRAMMING_API FSimulationActiveRegions AddSimulationActiveRegionsPass(
+		FRDGBuilder& graph, ERHIFeatureLevel::Type featureLevel,
+		FRDGBufferRef tileActivity, uint32 nTiles,
+		uint32 groupsPerTile = 1,
+		bool asyncCompute = false
+	);
+}
@@ -12,4 +12,7 @@ public:
 	virtual void ShutdownModule() override;
 };
 
-EXTENDEDGRAPHICSPROGRAMMING_API DECLARE_LOG_CATEGORY_EXTERN(LogEGP, Warning, Log);
\ No newline at end of file
+EXTENDEDGRAPHICSPROGRAMMING_API DECLARE_LOG_CATEGORY_EXTERN(LogEGP, Warning, Log);
+
+//View with 'stat EGP'.
+DECLARE_STATS_GROUP(TEXT("Extended Graphics Programming"), STATGROUP_EGP, STATCAT_Advanced);
\ No newline at end of file
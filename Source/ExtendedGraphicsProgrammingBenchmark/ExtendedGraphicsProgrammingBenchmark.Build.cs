@@ -0,0 +1,21 @@
+﻿using UnrealBuildTool;
+
+//The 'EGP.Benchmark' console command and its test pass.
+//Kept out of the main module so that none of it ships.
+public class ExtendedGraphicsProgrammingBenchmark : ModuleRules
+{
+	public ExtendedGraphicsProgrammingBenchmark(ReadOnlyTargetRules Target) : base(Target)
+	{
+		PCHUsage = ModuleRules.PCHUsageMode.UseExplicitOrSharedPCHs;
+		
+		PublicDependencyModuleNames.AddRange(new string[] {
+			"Core"
+		});
+		PrivateDependencyModuleNames.AddRange(new string[] {
+			"CoreUObject",
+			"Engine",
+			"Renderer", "RenderCore", "RHI",
+			"ExtendedGraphicsProgramming"
+		});
+	}
+}
@@ -0,0 +1,394 @@
+#include "EGP_Benchmark.h"
+
+#include "RenderCore.h"
+#include "Containers/Ticker.h"
+#include "Engine/StaticMesh.h"
+#include "Engine/StaticMeshActor.h"
+#include "Engine/SceneCapture2D.h"
+#include "Engine/TextureRenderTarget2D.h"
+#include "Components/SceneCaptureComponent2D.h"
+#include "Components/StaticMeshComponent.h"
+#include "GameFramework/PlayerController.h"
+#include "Misc/FileHelper.h"
+
+#include "EGP_GetMeshBatches.h"
+
+
+class F_EGP_BenchmarkSceneViewExtension : public T_EGP_RenderPassSceneViewExtension<U_EGP_BenchmarkPass, U_EGP_BenchmarkComponent, FEGPBenchmarkProxy>
+{
+public:
+
+	F_EGP_BenchmarkSceneViewExtension(const FAutoRegister& r, U_EGP_BenchmarkPass* pass)
+		: T_EGP_RenderPassSceneViewExtension(r, pass) { }
+
+	virtual void OnPrePostProcessPass_RenderThread(FRDGBuilder& graph, const FSceneView& view,
+												   const FPostProcessingInputs& inputs) override
+	{
+		const auto& viewInfo = static_cast<const FViewInfo&>(view);
+
+		//Time the two stages that a typical mesh pass goes through for every view.
+		const uint64 startCycles = FPlatformTime::Cycles64();
+		primitivesBuffer.Reset();
+		ForEachComponent_RenderThread([&](const U_EGP_BenchmarkComponent&, const FEGPBenchmarkProxy&,
+										  const UPrimitiveComponent&, const FPrimitiveSceneProxy& primitive)
+		{
+			primitivesBuffer.Add(&primitive);
+		});
+		const uint64 midCycles = FPlatformTime::Cycles64();
+
+		int32 nBatches = 0;
+		for (const auto* primitive : primitivesBuffer)
+			EGP::ForEachBatch(viewInfo, primitive, [&](const auto&...) { nBatches += 1; });
+		const uint64 endCycles = FPlatformTime::Cycles64();
+
+		Pass->ForEachComponentCycles += (midCycles - startCycles);
+		Pass->ForEachBatchCycles += (endCycles - midCycles);
+		Pass->nBatchesGathered += nBatches;
+		Pass->nViewsRendered += 1;
+	}
+
+private:
+
+	TArray<const FPrimitiveSceneProxy*> primitivesBuffer;
+};
+
+
+U_EGP_BenchmarkPass::FTimings U_EGP_BenchmarkPass::ConsumeTimings()
+{
+	check(IsInGameThread());
+
+	FTimings output;
+	output.PassTick_GameThread = passTickCycles;
+	output.ForEachComponent_RenderThread = ForEachComponentCycles.exchange(0);
+	output.ForEachBatch_RenderThread = ForEachBatchCycles.exchange(0);
+	output.nViews = nViewsRendered.exchange(0);
+	output.nBatches = nBatchesGathered.exchange(0);
+	passTickCycles = 0;
+
+	return output;
+}
+void U_EGP_BenchmarkPass::Tick_GameThread(UWorld& thisWorld, float deltaSeconds)
+{
+	const uint64 startCycles = FPlatformTime::Cycles64();
+	Super::Tick_GameThread(thisWorld, deltaSeconds);
+	passTickCycles += FPlatformTime::Cycles64() - startCycles;
+}
+TSharedRef<F_EGP_RenderPassSceneViewExtension> U_EGP_BenchmarkPass::InitThisPass_GameThread(UWorld& thisWorld)
+{
+	return FSceneViewExtensions::NewExtension<F_EGP_BenchmarkSceneViewExtension>(this);
+}
+
+
+namespace
+{
+	struct FBenchmarkConfig
+	{
+		int32 nComponents = 0;
+		bool IsMoving = false;
+		int32 nViews = 1;
+		//If true, the extra (Scene Capture) views are rejected by the pass's view filter.
+		bool MainViewOnly = false;
+	};
+	struct FBenchmarkResult
+	{
+		FBenchmarkConfig Config;
+		//Averages per frame.
+		double ViewsRendered = 0, BatchesGathered = 0,
+			   PassTickMs = 0, ForEachComponentMs = 0, ForEachBatchMs = 0,
+			   GameThreadMs = 0, RenderThreadMs = 0, GPUMs = 0;
+	};
+
+	//Runs each benchmark configuration for a number of frames, then writes the results to a CSV file.
+	//Driven by the core ticker so it keeps going regardless of the world's own tick settings.
+	class FBenchmarkRunner
+	{
+	public:
+
+		FBenchmarkRunner(UWorld& world, TArray<FBenchmarkConfig>&& configs, int32 nWarmupFrames, int32 nMeasuredFrames)
+			: world(&world), configs(MoveTemp(configs)),
+			  nWarmupFrames(nWarmupFrames), nMeasuredFrames(nMeasuredFrames)
+		{
+			tickHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateRaw(this, &FBenchmarkRunner::Tick));
+		}
+		~FBenchmarkRunner()
+		{
+			if (tickHandle.IsValid())
+				FTSTicker::GetCoreTicker().RemoveTicker(tickHandle);
+			TearDown();
+		}
+
+		bool IsFinished() const { return !tickHandle.IsValid(); }
+
+	private:
+
+		static constexpr double Spacing = 60.0;
+
+		TWeakObjectPtr<UWorld> world;
+		TArray<FBenchmarkConfig> configs;
+		const int32 nWarmupFrames, nMeasuredFrames;
+		FTSTicker::FDelegateHandle tickHandle;
+
+		int32 configIdx = 0,
+			  frameIdx = 0;
+		FBenchmarkResult currentResult;
+		TArray<FBenchmarkResult> results;
+
+		TWeakObjectPtr<U_EGP_BenchmarkPass> pass;
+		TArray<TWeakObjectPtr<AActor>> spawnedActors;
+		TArray<FVector> basePositions;
+		TArray<TWeakObjectPtr<UTextureRenderTarget2D>> captureTargets;
+
+
+		bool Tick(float deltaSeconds)
+		{
+			if (!world.IsValid())
+			{
+				UE_LOG(LogEGP, Warning, TEXT("EGP benchmark cancelled because its world was destroyed"));
+				Finish();
+				return false;
+			}
+			if (configIdx >= configs.Num())
+			{
+				WriteResults();
+				Finish();
+				return false;
+			}
+
+			const auto& config = configs[configIdx];
+			if (frameIdx == 0)
+			{
+				SetUp(config);
+				currentResult = { config };
+			}
+
+			if (config.IsMoving)
+				MoveActors(world->GetTimeSeconds());
+
+			//The timings lag a frame or two behind, which evens out over the measured frames.
+			auto timings = pass.IsValid() ? pass->ConsumeTimings() : U_EGP_BenchmarkPass::FTimings{ };
+			if (frameIdx > nWarmupFrames)
+			{
+				currentResult.ViewsRendered += timings.nViews;
+				currentResult.BatchesGathered += timings.nBatches;
+				currentResult.PassTickMs += FPlatformTime::ToMilliseconds64(timings.PassTick_GameThread);
+				currentResult.ForEachComponentMs += FPlatformTime::ToMilliseconds64(timings.ForEachComponent_RenderThread);
+				currentResult.ForEachBatchMs += FPlatformTime::ToMilliseconds64(timings.ForEachBatch_RenderThread);
+				currentResult.GameThreadMs += FPlatformTime::ToMilliseconds(GGameThreadTime);
+				currentResult.RenderThreadMs += FPlatformTime::ToMilliseconds(GRenderThreadTime);
+				currentResult.GPUMs += FPlatformTime::ToMilliseconds(RHIGetGPUFrameCycles());
+			}
+
+			frameIdx += 1;
+			if (frameIdx > nWarmupFrames + nMeasuredFrames)
+			{
+				for (double* average : { &currentResult.ViewsRendered, &currentResult.BatchesGathered,
+										 &currentResult.PassTickMs, &currentResult.ForEachComponentMs, &currentResult.ForEachBatchMs,
+										 &currentResult.GameThreadMs, &currentResult.RenderThreadMs, &currentResult.GPUMs })
+				{
+					*average /= nMeasuredFrames;
+				}
+				results.Add(currentResult);
+				UE_LOG(LogEGP, Log, TEXT("EGP benchmark %i/%i: %s"), configIdx + 1, configs.Num(), *ToCSVRow(currentResult));
+
+				TearDown();
+				configIdx += 1;
+				frameIdx = 0;
+			}
+
+			return true;
+		}
+		void Finish()
+		{
+			TearDown();
+			tickHandle.Reset();
+		}
+
+		void SetUp(const FBenchmarkConfig& config)
+		{
+			auto* subsystem = world->GetSubsystem<U_EGP_RenderPassSubsystem>();
+			pass = Cast<U_EGP_BenchmarkPass>(subsystem->GetPass(U_EGP_BenchmarkPass::StaticClass(), true));
+
+			//Put everything in front of the first player's camera, so that the components are actually visible.
+			FVector cameraPos = FVector::ZeroVector;
+			FRotator cameraRot = FRotator::ZeroRotator;
+			if (auto* player = world->GetFirstPlayerController())
+				player->GetPlayerViewPoint(cameraPos, cameraRot);
+			const FVector gridCenter = cameraPos + (cameraRot.Vector() * 3000.0);
+			const FQuat gridRot = cameraRot.Quaternion();
+
+			auto* cube = LoadObject<UStaticMesh>(nullptr, TEXT("/Engine/BasicShapes/Cube.Cube"));
+			const int32 side = FMath::CeilToInt32(FMath::Sqrt(static_cast<double>(config.nComponents)));
+			for (int32 i = 0; i < config.nComponents; ++i)
+			{
+				const FVector gridPos{ 0, ((i % side) - (side / 2)) * Spacing, ((i / side) - (side / 2)) * Spacing };
+				const FVector pos = gridCenter + gridRot.RotateVector(gridPos);
+
+				auto* actor = world->SpawnActor<AStaticMeshActor>(pos, FRotator::ZeroRotator);
+				actor->SetMobility(EComponentMobility::Movable);
+				actor->GetStaticMeshComponent()->SetStaticMesh(cube);
+				actor->SetActorScale3D(FVector(0.25));
+
+				//Static components should only cost anything when they change.
+				auto* component = NewObject<U_EGP_BenchmarkComponent>(actor);
+				component->Target = actor->GetStaticMeshComponent();
+				component->SetProxyUpdateMode(E_EGP_ProxyUpdateMode::CompareBytes);
+				component->SetupAttachment(actor->GetRootComponent());
+				component->RegisterComponent();
+
+				spawnedActors.Add(actor);
+				basePositions.Add(pos);
+			}
+
+			//Every extra view is a Scene Capture, looking at the same components as the main view.
+			for (int32 i = 1; i < config.nViews; ++i)
+			{
+				auto* target = NewObject<UTextureRenderTarget2D>();
+				target->InitAutoFormat(256, 256);
+
+				auto* capture = world->SpawnActor<ASceneCapture2D>(cameraPos, cameraRot);
+				capture->GetCaptureComponent2D()->TextureTarget = target;
+				capture->GetCaptureComponent2D()->bCaptureEveryFrame = true;
+
+				if (config.MainViewOnly && pass.IsValid())
+					pass->ViewFilter->FilterByRenderTarget(target, false);
+
+				spawnedActors.Add(capture);
+				captureTargets.Add(target);
+			}
+		}
+		void MoveActors(double time)
+		{
+			for (int32 i = 0; i < basePositions.Num(); ++i)
+			{
+				auto* actor = spawnedActors[i].Get();
+				if (actor != nullptr)
+					actor->SetActorLocation(basePositions[i] + FVector(0, 0, Spacing * FMath::Sin(time + i)));
+			}
+		}
+		void TearDown()
+		{
+			for (auto& actor : spawnedActors)
+				if (actor.IsValid())
+					actor->Destroy();
+			spawnedActors.Empty();
+			basePositions.Empty();
+
+			if (pass.IsValid())
+			{
+				for (auto& target : captureTargets)
+					if (target.IsValid())
+						pass->ViewFilter->RemoveByRenderTarget(target.Get());
+				pass->ViewFilter->ClearsByRenderTarget();
+			}
+			captureTargets.Empty();
+		}
+
+		static FString ToCSVRow(const FBenchmarkResult& r)
+		{
+			return FString::Printf(TEXT("%i,%s,%i,%s,%.2f,%.1f,%.4f,%.4f,%.4f,%.4f,%.4f,%.4f"),
+								   r.Config.nComponents, r.Config.IsMoving ? TEXT("Moving") : TEXT("Static"),
+								   r.Config.nViews, r.Config.MainViewOnly ? TEXT("MainOnly") : TEXT("All"),
+								   r.ViewsRendered, r.BatchesGathered,
+								   r.PassTickMs, r.ForEachComponentMs, r.ForEachBatchMs,
+								   r.GameThreadMs, r.RenderThreadMs, r.GPUMs);
+		}
+		void WriteResults() const
+		{
+			FString csv = TEXT("Components,Motion,Views,Filter,ViewsRendered,MeshBatches,"
+							   "PassTickGameThreadMs,ForEachComponentRenderThreadMs,ForEachBatchRenderThreadMs,"
+							   "GameThreadFrameMs,RenderThreadFrameMs,GPUFrameMs\n");
+			for (const auto& result : results)
+				csv += ToCSVRow(result) + TEXT("\n");
+
+			const FString path = FPaths::Combine(FPaths::ProfilingDir(), TEXT("EGP"),
+												 FString::Printf(TEXT("Benchmark-%s.csv"), *FDateTime::Now().ToString()));
+			if (FFileHelper::SaveStringToFile(csv, *path))
+				UE_LOG(LogEGP, Log, TEXT("EGP benchmark finished; results written to '%s'"), *path);
+			else
+				UE_LOG(LogEGP, Error, TEXT("EGP benchmark finished but couldn't write results to '%s'"), *path);
+		}
+	};
+	TUniquePtr<FBenchmarkRunner> activeBenchmark;
+
+
+	TArray<int32> ParseIntList(const FString& args, const TCHAR* key, TArray<int32> defaults)
+	{
+		FString value;
+		if (!FParse::Value(*args, key, value))
+			return defaults;
+
+		TArray<FString> elements;
+		value.ParseIntoArray(elements, TEXT(","));
+		TArray<int32> output;
+		for (const auto& element : elements)
+			output.Add(FCString::Atoi(*element));
+		return output;
+	}
+	TArray<FString> ParseStringList(const FString& args, const TCHAR* key, TArray<FString> defaults)
+	{
+		FString value;
+		if (!FParse::Value(*args, key, value))
+			return defaults;
+
+		TArray<FString> output;
+		value.ParseIntoArray(output, TEXT(","));
+		return output;
+	}
+
+	void StartBenchmark(const TArray<FString>& argList, UWorld* world)
+	{
+		const FString args = FString::Join(argList, TEXT(" "));
+		if (activeBenchmark.IsValid() && !activeBenchmark->IsFinished())
+		{
+			if (args.Contains(TEXT("Cancel")))
+			{
+				activeBenchmark.Reset();
+				UE_LOG(LogEGP, Log, TEXT("EGP benchmark cancelled"));
+			}
+			else
+			{
+				UE_LOG(LogEGP, Warning, TEXT("An EGP benchmark is already running; use 'EGP.Benchmark Cancel' to stop it"));
+			}
+			return;
+		}
+		if (!IsValid(world))
+		{
+			UE_LOG(LogEGP, Error, TEXT("EGP.Benchmark needs a game world to run in"));
+			return;
+		}
+
+		const auto counts = ParseIntList(args, TEXT("Counts="), { 100, 1000, 10000, 100000 });
+		const auto views = ParseIntList(args, TEXT("Views="), { 1, 2, 3, 4 });
+		const auto motions = ParseStringList(args, TEXT("Motion="), { TEXT("Static"), TEXT("Moving") });
+		const auto filters = ParseStringList(args, TEXT("Filters="), { TEXT("All"), TEXT("MainOnly") });
+		int32 nWarmupFrames = 30,
+			  nMeasuredFrames = 120;
+		FParse::Value(*args, TEXT("Warmup="), nWarmupFrames);
+		FParse::Value(*args, TEXT("Frames="), nMeasuredFrames);
+
+		TArray<FBenchmarkConfig> configs;
+		for (int32 count : counts)
+			for (const auto& motion : motions)
+				for (int32 nViews : views)
+					for (const auto& filter : filters)
+					{
+						//With one view, there's nothing for the filter to reject.
+						const bool mainViewOnly = (filter == TEXT("MainOnly"));
+						if (mainViewOnly && nViews < 2)
+							continue;
+						configs.Add({ FMath::Max(0, count), motion == TEXT("Moving"), FMath::Clamp(nViews, 1, 4), mainViewOnly });
+					}
+
+		UE_LOG(LogEGP, Log, TEXT("Starting EGP benchmark with %i configurations"), configs.Num());
+		activeBenchmark = MakeUnique<FBenchmarkRunner>(*world, MoveTemp(configs),
+													   FMath::Max(0, nWarmupFrames), FMath::Max(1, nMeasuredFrames));
+	}
+
+	FAutoConsoleCommandWithWorldAndArgs BenchmarkCommand(
+		TEXT("EGP.Benchmark"),
+		TEXT("Measures how custom render passes scale, writing the results to a CSV file in the Profiling folder. "
+			 "Optional arguments (comma-separated lists): Counts=100,1000,10000,100000 Views=1,2,3,4 "
+			 "Motion=Static,Moving Filters=All,MainOnly Warmup=30 Frames=120. Pass 'Cancel' to stop a running benchmark."),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&StartBenchmark)
+	);
+}
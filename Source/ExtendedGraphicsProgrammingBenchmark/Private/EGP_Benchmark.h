@@ -0,0 +1,63 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+#include "EGP_CustomRenderPasses.h"
+
+#include "EGP_Benchmark.generated.h"
+
+//A trivial custom pass used by the 'EGP.Benchmark' console command,
+//    to measure how the custom pass framework scales with component and view counts.
+
+
+struct FEGPBenchmarkProxy
+{
+	FVector3f Location;
+};
+
+UCLASS(Transient, NotBlueprintable)
+class U_EGP_BenchmarkPass : public U_EGP_RenderPass
+{
+	GENERATED_BODY()
+public:
+
+	//Time spent in each stage since the last call to 'ConsumeTimings()', in cycles.
+	struct FTimings
+	{
+		uint64 PassTick_GameThread = 0,
+			   ForEachComponent_RenderThread = 0,
+			   ForEachBatch_RenderThread = 0;
+		int32 nViews = 0;
+		int64 nBatches = 0;
+	};
+	//Game-thread only.
+	FTimings ConsumeTimings();
+
+	virtual void Tick_GameThread(UWorld& thisWorld, float deltaSeconds) override;
+
+	//Written by the pass's SVE, on the render thread.
+	std::atomic<uint64> ForEachComponentCycles = 0,
+						ForEachBatchCycles = 0;
+	std::atomic<int32> nViewsRendered = 0;
+	std::atomic<int64> nBatchesGathered = 0;
+
+protected:
+
+	virtual TSharedRef<F_EGP_RenderPassSceneViewExtension> InitThisPass_GameThread(UWorld& thisWorld) override;
+
+private:
+
+	uint64 passTickCycles = 0;
+};
+
+UCLASS(Transient, NotBlueprintable, NotPlaceable)
+class U_EGP_BenchmarkComponent : public U_EGP_RenderPassComponent
+{
+	GENERATED_BODY()
+public:
+
+	virtual TSubclassOf<U_EGP_RenderPass> GetPassType() const override { return U_EGP_BenchmarkPass::StaticClass(); }
+	virtual bool IsProxyConstructionThreadSafe() const override { return true; }
+
+	EGP_PASS_COMPONENT_SIMPLE_PROXY_IMPL(FEGPBenchmarkProxy, FEGPBenchmarkProxy{ FVector3f(GetComponentLocation()) })
+};